@@ -1,11 +1,22 @@
 #include <benchmark/benchmark.h>
 
 #include "../distance.hpp"
+#include "../chunk_width.hpp"
+#include "../window.hpp"
+#include "../bitmap_file.hpp"
+#include "../concurrent.hpp"
+#include "../find_run.hpp"
+#include "../histogram.hpp"
+#include "../bitmap_pool.hpp"
+#include "../memoized.hpp"
 
 #include <random>
 #include <array>
 #include <stdexcept>
 #include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 
 std::string random(size_t size, double q = .5) {
     std::mt19937 engine(1337);
@@ -77,11 +88,250 @@ BENCHMARK_CAPTURE(BM_process, R_120_ ## name, fn, wrapper(INF_CHALLENGE_R)); \
 BENCHMARK_CAPTURE(BM_process, RR_120_ ## name, fn, wrapper(INF_CHALLENGE_RR));
 
 DEF_BENCH(Slow, distanceSlow, wrapperBool);
+DEF_BENCH(VectorBool, distanceVectorBool, wrapperBool);
 DEF_BENCH(UintS, distanceUintSlow, wrapperUint);
 DEF_BENCH(UintBranchLess, distanceUintSlowBranchLess, wrapperUint);
 DEF_BENCH(MemoizedS, distanceMemoized, wrapperCustomBool);
 DEF_BENCH(MemoizedAligned, distanceMemoizedAligned, wrapperCustomBool);
 DEF_BENCH(MemoizedBranchLess, distanceMemoizedBranchLess, wrapperCustomBool);
+#ifdef __SSE4_2__
+DEF_BENCH(MemoizedSSE, distanceMemoizedSSE, wrapperCustomBool);
+#endif
+#ifdef __AVX2__
+DEF_BENCH(MemoizedAVX2, distanceMemoizedAVX2, wrapperCustomBool);
+#endif
+#ifdef AVX512F
+DEF_BENCH(MemoizedAVX, distanceMemoizedAVX, wrapperCustomBool);
+#endif
+DEF_BENCH(MemoizedPackedState, distanceMemoizedPackedState, wrapperCustomBool);
+DEF_BENCH(MemoizedPacked, distanceMemoizedLayout<PackedLayout>, wrapperCustomBool);
+DEF_BENCH(MemoizedSoA, distanceMemoizedLayout<SoALayout>, wrapperCustomBool);
+DEF_BENCH(MemoizedBitPacked, distanceMemoizedLayout<BitPackedLayout>, wrapperCustomBool);
+DEF_BENCH(MemoizedBranchLessPacked, distanceMemoizedBranchLessLayout<PackedLayout>, wrapperCustomBool);
+DEF_BENCH(MemoizedBranchLessSoA, distanceMemoizedBranchLessLayout<SoALayout>, wrapperCustomBool);
+DEF_BENCH(MemoizedBranchLessBitPacked, distanceMemoizedBranchLessLayout<BitPackedLayout>, wrapperCustomBool);
+
+// chunk width sweep, the table is 3 * 2^Width bytes: pick the width per deployment
+DEF_BENCH(MemoizedWidth8, distanceMemoizedWidth<8>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth9, distanceMemoizedWidth<9>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth10, distanceMemoizedWidth<10>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth11, distanceMemoizedWidth<11>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth12, distanceMemoizedWidth<12>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth13, distanceMemoizedWidth<13>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth14, distanceMemoizedWidth<14>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth15, distanceMemoizedWidth<15>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidth16, distanceMemoizedWidth<16>, wrapperCustomBool);
+#ifdef __AVX2__
+DEF_BENCH(MemoizedWidthGather8, distanceMemoizedWidthGather<8>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidthGather10, distanceMemoizedWidthGather<10>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidthGather12, distanceMemoizedWidthGather<12>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidthGather14, distanceMemoizedWidthGather<14>, wrapperCustomBool);
+DEF_BENCH(MemoizedWidthGather16, distanceMemoizedWidthGather<16>, wrapperCustomBool);
+#endif
+
+// The call site keeps its own hot data, so the table is evicted from L1 before every call.
+// TrashOnly is the cost of the eviction itself.
+static constexpr auto L1_TRASH_SIZE = 2 * 32 * 1024;
+static inline std::vector<uint8_t> L1_TRASH(L1_TRASH_SIZE, 0);
+
+template <typename Fn, typename Challenge>
+static void BM_processTrashL1(benchmark::State& state, Fn fn, Challenge challenge) {
+    for (auto _ : state) {
+        for (auto i = 0u; i < L1_TRASH.size(); i += 64) {
+            ++L1_TRASH[i];
+        }
+        benchmark::ClobberMemory();
+        fn(challenge);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(challenge.size() * state.iterations()));
+}
+
+void trashOnly(BoolVector&) {}
+
+#define DEF_TRASH_BENCH(name, fn, wrapper) \
+BENCHMARK_CAPTURE(BM_processTrashL1, EQ_0_ ## name, fn, wrapper(MID_CHALLENGE)); \
+BENCHMARK_CAPTURE(BM_processTrashL1, EQ_1_ ## name, fn, wrapper(LONG1_CHALLENGE)); \
+BENCHMARK_CAPTURE(BM_processTrashL1, R_1_ ## name, fn, wrapper(LONG1_CHALLENGE_R)); \
+BENCHMARK_CAPTURE(BM_processTrashL1, EQ_30_ ## name, fn, wrapper(LONG30_CHALLENGE));
+
+DEF_TRASH_BENCH(TrashOnly, trashOnly, wrapperCustomBool);
+DEF_TRASH_BENCH(MemoizedS, distanceMemoized, wrapperCustomBool);
+DEF_TRASH_BENCH(MemoizedPacked, distanceMemoizedLayout<PackedLayout>, wrapperCustomBool);
+DEF_TRASH_BENCH(MemoizedSoA, distanceMemoizedLayout<SoALayout>, wrapperCustomBool);
+DEF_TRASH_BENCH(MemoizedBitPacked, distanceMemoizedLayout<BitPackedLayout>, wrapperCustomBool);
+
+static void BM_window(benchmark::State& state, std::string const& challenge, bool circular) {
+    auto const stream = wrapperCustomBool(challenge);
+    SlidingGapWindow window(static_cast<size_t>(state.range(0)), circular);
+
+    size_t i = 0;
+    for (auto _ : state) {
+        window.pushByte(stream.rawData()[i]);
+        benchmark::DoNotOptimize(window.longest());
+        if (++i == stream.fullChunks()) {
+            i = 0;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(8 * state.iterations()));
+}
+
+BENCHMARK_CAPTURE(BM_window, EQ_120, INF_CHALLENGE, false)->Arg(1024)->Arg(8 * 1024 * 30);
+BENCHMARK_CAPTURE(BM_window, RR_120, INF_CHALLENGE_RR, false)->Arg(1024)->Arg(8 * 1024 * 30);
+BENCHMARK_CAPTURE(BM_window, EQ_120_Circular, INF_CHALLENGE, true)->Arg(1024)->Arg(8 * 1024 * 30);
+
+// reload + the first query, the summaries replace the full scan
+static void BM_mappedReload(benchmark::State& state, std::string const& challenge) {
+    auto const path = (std::filesystem::temp_directory_path() / "bench_bitmap.bin").string();
+    MappedBitmap::save(wrapperCustomBool(challenge), path);
+
+    for (auto _ : state) {
+        MappedBitmap bitmap(path);
+        benchmark::DoNotOptimize(bestSlot(bitmap.summary()));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(challenge.size() * state.iterations()));
+    std::filesystem::remove(path);
+}
+
+BENCHMARK_CAPTURE(BM_mappedReload, EQ_120, INF_CHALLENGE);
+BENCHMARK_CAPTURE(BM_mappedReload, RR_120, INF_CHALLENGE_RR);
+
+// Contention: every thread claims a slot from one bitmap and frees it, so both variants do the same work
+static std::unique_ptr<BoolVector> SHARED_BOOL_VECTOR;
+static std::mutex SHARED_MUTEX;
+static std::unique_ptr<ConcurrentBoolVector> SHARED_CONCURRENT;
+
+static void BM_claimMutex(benchmark::State& state, std::string const& challenge) {
+    if (state.thread_index() == 0) {
+        SHARED_BOOL_VECTOR = std::make_unique<BoolVector>(wrapperCustomBool(challenge));
+    }
+
+    for (auto _ : state) {
+        size_t slot;
+        {
+            std::lock_guard lock(SHARED_MUTEX);
+            auto& bitmap = *SHARED_BOOL_VECTOR;
+            slot = bestSlot(summarize(bitmap.rawData(), bitmap.size()));
+            bitmap.set(slot, true);
+        }
+        std::lock_guard lock(SHARED_MUTEX);
+        SHARED_BOOL_VECTOR->set(slot, false);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+static void BM_claimConcurrent(benchmark::State& state, std::string const& challenge) {
+    if (state.thread_index() == 0) {
+        SHARED_CONCURRENT = std::make_unique<ConcurrentBoolVector>(wrapperCustomBool(challenge));
+    }
+
+    for (auto _ : state) {
+        auto const slot = SHARED_CONCURRENT->claimBestGap();
+        SHARED_CONCURRENT->release(*slot);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK_CAPTURE(BM_claimMutex, EQ_30, LONG30_CHALLENGE)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK_CAPTURE(BM_claimConcurrent, EQ_30, LONG30_CHALLENGE)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK_CAPTURE(BM_claimMutex, RR_120, INF_CHALLENGE_RR)->ThreadRange(2, 64)->UseRealTime();
+BENCHMARK_CAPTURE(BM_claimConcurrent, RR_120, INF_CHALLENGE_RR)->ThreadRange(2, 64)->UseRealTime();
+
+template <typename Fn, typename Challenge>
+static void BM_findRun(benchmark::State& state, Fn fn, Challenge challenge, FitPolicy policy) {
+    auto const length = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fn(challenge, length, policy));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(challenge.size() * state.iterations()));
+}
+
+#define DEF_FIND_RUN_BENCH(name, fn, wrapper, policy) \
+BENCHMARK_CAPTURE(BM_findRun, EQ_120_ ## name, fn, wrapper(INF_CHALLENGE), policy)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->Arg(256); \
+BENCHMARK_CAPTURE(BM_findRun, R_120_ ## name, fn, wrapper(INF_CHALLENGE_R), policy)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->Arg(256); \
+BENCHMARK_CAPTURE(BM_findRun, RR_120_ ## name, fn, wrapper(INF_CHALLENGE_RR), policy)->Arg(1)->Arg(4)->Arg(16)->Arg(64)->Arg(256);
+
+DEF_FIND_RUN_BENCH(FirstSlow, findRunSlow, wrapperBool, FitPolicy::First);
+DEF_FIND_RUN_BENCH(First, findRun, wrapperCustomBool, FitPolicy::First);
+DEF_FIND_RUN_BENCH(BestSlow, findRunSlow, wrapperBool, FitPolicy::Best);
+DEF_FIND_RUN_BENCH(Best, findRun, wrapperCustomBool, FitPolicy::Best);
+
+static GapHistogram gapHistogramThreads(BoolVector const& input) {
+    return gapHistogram(input, 4);
+}
+
+template <typename Fn, typename Challenge>
+static void BM_histogram(benchmark::State& state, Fn fn, Challenge challenge) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fn(challenge));
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(challenge.size() * state.iterations()));
+}
+
+// real time: the threaded version works outside the calling thread
+#define DEF_HISTOGRAM_BENCH(name, fn, wrapper) \
+BENCHMARK_CAPTURE(BM_histogram, EQ_120_ ## name, fn, wrapper(INF_CHALLENGE))->UseRealTime(); \
+BENCHMARK_CAPTURE(BM_histogram, R_120_ ## name, fn, wrapper(INF_CHALLENGE_R))->UseRealTime(); \
+BENCHMARK_CAPTURE(BM_histogram, RR_120_ ## name, fn, wrapper(INF_CHALLENGE_RR))->UseRealTime();
+
+DEF_HISTOGRAM_BENCH(Slow, gapHistogramSlow, wrapperBool);
+DEF_HISTOGRAM_BENCH(Memoized, static_cast<GapHistogram(*)(BoolVector const&)>(gapHistogram), wrapperCustomBool);
+DEF_HISTOGRAM_BENCH(Threads4, gapHistogramThreads, wrapperCustomBool);
+
+// The challenge is cut into range(0) bitmaps, every iteration places a slot into the best one and frees it
+static std::vector<BoolVector> splitBitmaps(std::string const& challenge, size_t count) {
+    auto const bits = challenge.size() / count;
+    std::vector<BoolVector> out;
+    for (auto i = 0u; i != count; ++i) {
+        out.push_back(wrapperCustomBool(challenge.substr(i * bits, bits)));
+    }
+    return out;
+}
+
+static void BM_poolNaive(benchmark::State& state, std::string const& challenge) {
+    auto bitmaps = splitBitmaps(challenge, static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        size_t best = 0;
+        GapSummary bestSummary{};
+        for (auto i = 0u; i != bitmaps.size(); ++i) {
+            auto const summary = summarize(bitmaps[i].rawData(), bitmaps[i].size());
+            if (summary.longest > bestSummary.longest) {
+                best = i;
+                bestSummary = summary;
+            }
+        }
+        auto const slot = bestSlot(bestSummary);
+        bitmaps[best].set(slot, true);
+        bitmaps[best].set(slot, false);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+static void BM_pool(benchmark::State& state, std::string const& challenge) {
+    BitmapPool pool;
+    for (auto& bitmap : splitBitmaps(challenge, static_cast<size_t>(state.range(0)))) {
+        pool.add(std::move(bitmap));
+    }
+    for (auto _ : state) {
+        auto const placement = pool.placeBest();
+        pool.set(placement->bitmap, placement->slot, false);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["scans"] = benchmark::Counter(static_cast<double>(pool.scans()), benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_CAPTURE(BM_poolNaive, R_120, INF_CHALLENGE_R)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_CAPTURE(BM_pool, R_120, INF_CHALLENGE_R)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_CAPTURE(BM_poolNaive, RR_120, INF_CHALLENGE_RR)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK_CAPTURE(BM_pool, RR_120, INF_CHALLENGE_RR)->Arg(100)->Arg(1000)->Arg(10000);
 
 
 BENCHMARK_MAIN();
\ No newline at end of file
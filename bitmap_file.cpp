@@ -0,0 +1,202 @@
+#include "bitmap_file.hpp"
+
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC{'G', 'A', 'P', 'B', 'I', 'T', 'S', '\0'};
+constexpr size_t ALIGN = 64;
+
+constexpr size_t alignUp(size_t value) {
+    return (value + ALIGN - 1) / ALIGN * ALIGN;
+}
+
+constexpr size_t bitsOffset() {
+    return alignUp(sizeof(MappedBitmap::Header));
+}
+
+constexpr size_t treeOffset(size_t chunks) {
+    return bitsOffset() + alignUp(chunks);
+}
+
+constexpr size_t fileSize(size_t chunks, size_t leaves) {
+    return treeOffset(chunks) + 2 * leaves * sizeof(MappedBitmap::Node);
+}
+
+constexpr uint64_t hashWord(uint64_t word, size_t index) {
+    // splitmix64 finalizer, the index keeps swapped words visible
+    auto z = word + 0x9e3779b97f4a7c15ull * (index + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+uint64_t loadWord(const uint8_t* bits, size_t index) {
+    uint64_t word;
+    std::memcpy(&word, bits + index * sizeof(word), sizeof(word));
+    return word;
+}
+
+// bits region is padded to ALIGN, so it is always made of full words
+uint64_t checksum(const uint8_t* bits, size_t chunks) {
+    uint64_t out = 0;
+    for (auto i = 0u; i != alignUp(chunks) / sizeof(uint64_t); ++i) {
+        out ^= hashWord(loadWord(bits, i), i);
+    }
+    return out;
+}
+
+MappedBitmap::Node toNode(GapSummary const& summary) {
+    assert(!summary.inChunk);
+    return {summary.begin, summary.size, summary.prefix, summary.suffix, summary.longest, summary.longestPos};
+}
+
+GapSummary fromNode(MappedBitmap::Node const& node) {
+    return {node.begin, node.size, node.prefix, node.suffix, node.longest, node.longestPos, false};
+}
+
+GapSummary summarizeBlock(const uint8_t* bits, size_t size, size_t blockBits, size_t block) {
+    auto const begin = block * blockBits;
+    return summarize(bits + begin / 8, std::min(blockBits, size - begin), begin);
+}
+
+}
+
+void MappedBitmap::save(BoolVector const& input, std::string const& path, uint32_t blockBits) {
+    if (input.size() == 0 || blockBits == 0 || blockBits % 8 != 0) {
+        throw std::invalid_argument("Bitmap must be non-empty, block size must be a positive multiple of 8");
+    }
+
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.blockBits = blockBits;
+    header.size = input.size();
+    header.blocks = (input.size() + blockBits - 1) / blockBits;
+    header.leaves = std::bit_ceil(header.blocks);
+
+    std::vector<uint8_t> bits(alignUp(input.chunks()), 0);
+    std::memcpy(bits.data(), input.rawData(), input.chunks());
+    if (auto const tail = input.size() % 8; tail != 0) {
+        bits[input.chunks() - 1] &= (1u << tail) - 1;
+    }
+    header.checksum = checksum(bits.data(), input.chunks());
+
+    std::vector<Node> tree(2 * header.leaves, Node{});
+    for (auto i = 0u; i != header.blocks; ++i) {
+        tree[header.leaves + i] = toNode(summarizeBlock(bits.data(), input.size(), blockBits, i));
+    }
+    for (auto i = header.leaves - 1; i != 0; --i) {
+        tree[i] = toNode(merge(fromNode(tree[2 * i]), fromNode(tree[2 * i + 1])));
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::vector<char> padding(bitsOffset() - sizeof(Header), 0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    out.write(reinterpret_cast<const char*>(bits.data()), static_cast<std::streamsize>(bits.size()));
+    out.write(reinterpret_cast<const char*>(tree.data()), static_cast<std::streamsize>(tree.size() * sizeof(Node)));
+    if (!out) {
+        throw std::runtime_error("Cannot write bitmap to " + path);
+    }
+}
+
+MappedBitmap::MappedBitmap(std::string const& path) {
+    m_fd = ::open(path.c_str(), O_RDWR);
+    if (m_fd < 0) {
+        throw std::runtime_error("Cannot open bitmap " + path);
+    }
+
+    struct stat st{};
+    if (::fstat(m_fd, &st) != 0 || static_cast<size_t>(st.st_size) < bitsOffset()) {
+        ::close(m_fd);
+        throw std::runtime_error("Bitmap file is truncated: " + path);
+    }
+    m_mapSize = static_cast<size_t>(st.st_size);
+
+    auto* map = ::mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        ::close(m_fd);
+        throw std::runtime_error("Cannot map bitmap " + path);
+    }
+    m_map = static_cast<uint8_t*>(map);
+    m_header = reinterpret_cast<Header*>(m_map);
+
+    auto const chunks = (m_header->size + 7) / 8;
+    bool valid = m_header->magic == MAGIC
+            && m_header->version == VERSION
+            && m_header->blockBits != 0 && m_header->blockBits % 8 == 0
+            && m_header->size != 0
+            && m_header->blocks == (m_header->size + m_header->blockBits - 1) / m_header->blockBits
+            && m_header->leaves == std::bit_ceil(m_header->blocks)
+            && m_mapSize == fileSize(chunks, m_header->leaves);
+    if (!valid) {
+        ::munmap(m_map, m_mapSize);
+        ::close(m_fd);
+        throw std::runtime_error("Bitmap file has a wrong header: " + path);
+    }
+
+    m_bits = m_map + bitsOffset();
+    m_tree = reinterpret_cast<Node*>(m_map + treeOffset(chunks));
+}
+
+MappedBitmap::~MappedBitmap() {
+    ::munmap(m_map, m_mapSize);
+    ::close(m_fd);
+}
+
+void MappedBitmap::updateBlock(size_t block) {
+    auto const leaves = m_header->leaves;
+    m_tree[leaves + block] = toNode(summarizeBlock(m_bits, size(), m_header->blockBits, block));
+    for (auto i = (leaves + block) / 2; i != 0; i /= 2) {
+        m_tree[i] = toNode(merge(fromNode(m_tree[2 * i]), fromNode(m_tree[2 * i + 1])));
+    }
+}
+
+void MappedBitmap::set(size_t index, bool value) {
+    assert(index < size());
+    auto const byteIndex = index / 8;
+    auto const wordIndex = byteIndex / sizeof(uint64_t);
+    auto const oldWord = loadWord(m_bits, wordIndex);
+
+    if (value) {
+        m_bits[byteIndex] |= (1 << (index % 8));
+    } else {
+        m_bits[byteIndex] &= ~(1 << (index % 8));
+    }
+
+    auto const newWord = loadWord(m_bits, wordIndex);
+    if (oldWord == newWord) {
+        return;
+    }
+    m_header->checksum ^= hashWord(oldWord, wordIndex) ^ hashWord(newWord, wordIndex);
+    updateBlock(index / m_header->blockBits);
+}
+
+GapSummary MappedBitmap::summary() const {
+    return fromNode(m_tree[1]);
+}
+
+void MappedBitmap::distance() {
+    set(bestSlot(summary()), true);
+}
+
+bool MappedBitmap::verify() const {
+    return checksum(m_bits, (size() + 7) / 8) == m_header->checksum;
+}
+
+void MappedBitmap::sync() const {
+    if (::msync(m_map, m_mapSize, MS_SYNC) != 0) {
+        throw std::runtime_error("Cannot sync bitmap");
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "distance.hpp"
+#include "memoized.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+
+// On-disk bitmap: header, packed bits and a segment tree of block summaries.
+// The file is mapped, so the first query is answered from the summaries without a scan,
+// and set() rescans only one block and the path to the root.
+class MappedBitmap {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t DEFAULT_BLOCK_BITS = 4096;
+
+    struct Header {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t blockBits;
+        uint64_t size;
+        uint64_t blocks;
+        uint64_t leaves; // the power of two >= blocks
+        uint64_t checksum; // of the packed bits
+    };
+
+    struct Node {
+        uint64_t begin, size, prefix, suffix, longest, longestPos;
+    };
+
+    static void save(BoolVector const& input, std::string const& path, uint32_t blockBits = DEFAULT_BLOCK_BITS);
+
+    explicit MappedBitmap(std::string const& path);
+    ~MappedBitmap();
+
+    MappedBitmap(MappedBitmap const&) = delete;
+    MappedBitmap& operator=(MappedBitmap const&) = delete;
+
+    bool get(size_t index) const {
+        assert(index < size());
+        return (m_bits[index / 8] & (1 << (index % 8))) != 0;
+    }
+
+    void set(size_t index, bool value);
+
+    size_t size() const {
+        return m_header->size;
+    }
+
+    const uint8_t* rawData() const {
+        return m_bits;
+    }
+
+    GapSummary summary() const;
+
+    // the same as distanceMemoized, the longest seq comes from the summaries
+    void distance();
+
+    // full scan of the packed bits against the header checksum
+    bool verify() const;
+
+    void sync() const;
+
+private:
+    int m_fd = -1;
+    uint8_t* m_map = nullptr;
+    size_t m_mapSize = 0;
+
+    Header* m_header = nullptr;
+    uint8_t* m_bits = nullptr;
+    Node* m_tree = nullptr;
+
+    void updateBlock(size_t block);
+};
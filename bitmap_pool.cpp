@@ -0,0 +1,126 @@
+#include "bitmap_pool.hpp"
+#include "memoized.hpp"
+
+#include <algorithm>
+#include <bit>
+
+
+size_t BitmapPool::add(BoolVector bitmap) {
+    size_t ones = 0;
+    for (auto i = 0u; i != bitmap.chunks(); ++i) {
+        ones += std::popcount(bitmap.rawData()[i]);
+    }
+
+    auto const index = m_bitmaps.size();
+    auto const zeros = bitmap.size() - ones;
+    m_bitmaps.push_back({std::move(bitmap), zeros, zeros});
+    push(index);
+    return index;
+}
+
+void BitmapPool::set(size_t index, size_t bit, bool value) {
+    assert(index < size());
+    auto& bitmap = m_bitmaps[index];
+    if (bitmap.bits.get(bit) == value) {
+        return;
+    }
+
+    bitmap.bits.set(bit, value);
+    if (value) {
+        --bitmap.zeros;
+        setBound(index, std::min(bitmap.bound, bitmap.zeros));
+    } else {
+        // the new zero can join two seqs
+        ++bitmap.zeros;
+        setBound(index, std::min(bitmap.bound * 2 + 1, bitmap.zeros));
+    }
+}
+
+std::optional<BitmapPool::Placement> BitmapPool::findBest() {
+    std::optional<size_t> best;
+    std::vector<size_t> visited;
+    auto bestEntry = [&] {
+        return Entry{m_bitmaps[*best].bound, *best, 0};
+    };
+
+    while (!m_heap.empty()) {
+        auto const top = m_heap.front();
+        auto& bitmap = m_bitmaps[top.index];
+        if (top.version != bitmap.version) {
+            std::pop_heap(m_heap.begin(), m_heap.end());
+            m_heap.pop_back();
+            continue;
+        }
+        if (best && !(bestEntry() < top)) {
+            break;
+        }
+
+        std::pop_heap(m_heap.begin(), m_heap.end());
+        m_heap.pop_back();
+        if (!bitmap.exact) {
+            scan(bitmap);
+        }
+        visited.push_back(top.index);
+        if (!best || bestEntry() < Entry{bitmap.bound, top.index, 0}) {
+            best = top.index;
+        }
+    }
+
+    // back with the exact bounds
+    for (auto index : visited) {
+        push(index);
+    }
+
+    if (!best || m_bitmaps[*best].bound == 0) {
+        return std::nullopt;
+    }
+    return Placement{*best, m_bitmaps[*best].slot, m_bitmaps[*best].bound};
+}
+
+std::optional<BitmapPool::Placement> BitmapPool::placeBest() {
+    auto const placement = findBest();
+    if (placement) {
+        auto& bitmap = m_bitmaps[placement->bitmap];
+        bitmap.bits.set(placement->slot, true);
+        --bitmap.zeros;
+        // the old size stays an upper bound
+        bitmap.exact = false;
+    }
+    return placement;
+}
+
+void BitmapPool::push(size_t index) {
+    auto& bitmap = m_bitmaps[index];
+    ++bitmap.version;
+
+    // too many dead entries, rebuild from the live ones
+    if (m_heap.size() >= 2 * m_bitmaps.size() + 16) [[unlikely]] {
+        m_heap.clear();
+        for (auto i = 0u; i != m_bitmaps.size(); ++i) {
+            if (i != index) {
+                m_heap.push_back({m_bitmaps[i].bound, i, m_bitmaps[i].version});
+            }
+        }
+        std::make_heap(m_heap.begin(), m_heap.end());
+    }
+
+    m_heap.push_back({bitmap.bound, index, bitmap.version});
+    std::push_heap(m_heap.begin(), m_heap.end());
+}
+
+void BitmapPool::scan(Bitmap& bitmap) {
+    ++m_scans;
+    auto const summary = summarize(bitmap.bits.rawData(), bitmap.bits.size());
+    bitmap.bound = summary.longest;
+    bitmap.slot = summary.longest != 0 ? bestSlot(summary) : 0;
+    bitmap.exact = true;
+}
+
+void BitmapPool::setBound(size_t index, size_t bound) {
+    auto& bitmap = m_bitmaps[index];
+    bitmap.exact = false;
+    if (bitmap.bound != bound) {
+        bitmap.bound = bound;
+        push(index);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "distance.hpp"
+
+#include <optional>
+#include <vector>
+
+
+// Many bitmaps, the query picks the one with the longest seq of `0` and sets its slot like distanceMemoized.
+// Every bitmap keeps an upper bound of its longest seq: the count of zeros at first, the exact size after a scan.
+// The query visits bitmaps by bound and stops once no bound can beat the best exact size found,
+// so only a few bitmaps are scanned when the bounds are tight.
+class BitmapPool {
+public:
+    struct Placement {
+        size_t bitmap;
+        size_t slot;
+        size_t seqSize; // longest seq before the slot was set
+    };
+
+    // returns the index of the bitmap
+    size_t add(BoolVector bitmap);
+
+    size_t size() const {
+        return m_bitmaps.size();
+    }
+
+    BoolVector const& bitmap(size_t index) const {
+        assert(index < size());
+        return m_bitmaps[index].bits;
+    }
+
+    void set(size_t index, size_t bit, bool value);
+
+    // the bitmap with the longest seq, the first one on ties; nullopt if there are no zeros
+    std::optional<Placement> findBest();
+
+    // findBest and set the slot of the winner
+    std::optional<Placement> placeBest();
+
+    // bitmaps scanned in total, the bound is exact without a scan otherwise
+    size_t scans() const {
+        return m_scans;
+    }
+
+private:
+    struct Bitmap {
+        BoolVector bits;
+        size_t zeros = 0;
+        size_t bound = 0; // >= longest seq
+        size_t slot = 0; // valid if exact
+        uint64_t version = 0; // only the heap entry with the same version is live
+        bool exact = false;
+    };
+
+    struct Entry {
+        size_t bound;
+        size_t index;
+        uint64_t version;
+
+        // the heap top is the largest bound, the smallest index on ties
+        bool operator<(Entry const& rhs) const {
+            return bound < rhs.bound || (bound == rhs.bound && index > rhs.index);
+        }
+    };
+
+    std::vector<Bitmap> m_bitmaps;
+    std::vector<Entry> m_heap;
+    size_t m_scans = 0;
+
+    void push(size_t index);
+    void scan(Bitmap& bitmap);
+    void setBound(size_t index, size_t bound);
+};
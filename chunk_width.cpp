@@ -0,0 +1,156 @@
+#include "chunk_width.hpp"
+#include "memoized.hpp"
+
+#include <immintrin.h>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+
+namespace {
+
+// Width bits from bit `pos`, the bytes after the end are not read
+template <size_t Width>
+uint32_t loadChunk(const uint8_t* data, size_t bytes, size_t pos) {
+    auto const byte = pos / 8;
+    uint32_t value = 0;
+    if (byte + sizeof(value) <= bytes) [[likely]] {
+        std::memcpy(&value, data + byte, sizeof(value));
+    } else {
+        for (auto i = byte; i != bytes; ++i) {
+            value |= uint32_t{data[i]} << (8 * (i - byte));
+        }
+    }
+    return (value >> (pos % 8)) & ChunkTable<Width>::MASK;
+}
+
+// Gather: 8 chunks are loaded and looked up with AVX2 gathers, the state is updated by scalar code
+template <size_t Width, bool Gather>
+void distanceMemoizedWidthImpl(BoolVector& input) {
+    using Table = ChunkTable<Width>;
+    auto const size = input.size();
+    auto const chunks = size / Width;
+    auto const bytes = input.chunks();
+    auto const data = input.rawData();
+
+    size_t current = 0;
+    size_t longestSeqSize = 0;
+    size_t longestSeqPos = 0;
+    bool inChunk = false;
+
+    auto step = [&](size_t i, size_t np, size_t longest, size_t ns) {
+        if (np == Width) {
+            current += Width;
+        } else {
+            auto lp = np + current;
+            if (lp > longestSeqSize) [[unlikely]] {
+                longestSeqSize = lp;
+                assert(i * Width + np >= longestSeqSize);
+                longestSeqPos = i * Width + np - longestSeqSize;
+                inChunk = false;
+            }
+            if (longest > longestSeqSize) [[unlikely]] {
+                inChunk = true;
+                longestSeqSize = longest;
+                longestSeqPos = i * Width;
+            }
+            current = ns;
+        }
+    };
+
+    size_t i = 0;
+#ifdef __AVX2__
+    if constexpr (Gather) {
+        static constexpr size_t LANES = 8;
+        // a block of 8 chunks starts on a byte
+        auto const lanePos = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(Width));
+        auto const offsets = _mm256_srli_epi32(lanePos, 3);
+        auto const shifts = _mm256_and_si256(lanePos, _mm256_set1_epi32(7));
+        auto const mask = _mm256_set1_epi32(static_cast<int>(Table::MASK));
+        auto const table = reinterpret_cast<const int*>(Table::table.data());
+
+        // the 4-byte loads of the last lane stay inside the data
+        for (; i + LANES <= chunks && (i + LANES - 1) * Width / 8 + 4 <= bytes; i += LANES) {
+            auto const words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(data + i * Width / 8), offsets, 1);
+            auto const values = _mm256_and_si256(_mm256_srlv_epi32(words, shifts), mask);
+            if (_mm256_testz_si256(values, values)) {
+                current += LANES * Width;
+                continue;
+            }
+            auto const entries = _mm256_i32gather_epi32(table, _mm256_add_epi32(values, _mm256_slli_epi32(values, 1)), 1);
+            alignas(32) std::array<uint32_t, LANES> out;
+            _mm256_store_si256(reinterpret_cast<__m256i*>(out.data()), entries);
+            for (auto lane = 0u; lane != LANES; ++lane) {
+                step(i + lane, out[lane] & 0xff, (out[lane] >> 8) & 0xff, (out[lane] >> 16) & 0xff);
+            }
+        }
+    }
+#endif
+
+    for (; i != chunks; ++i) {
+        auto [np, longest, ns] = Table::get(loadChunk<Width>(data, bytes, i * Width));
+        step(i, np, longest, ns);
+    }
+
+    for (auto j = chunks * Width; j != size; ++j) {
+        auto t = input.get(j);
+        if (t == 1) {
+            if (longestSeqSize < current) {
+                longestSeqSize = current;
+                assert(j >= current);
+                longestSeqPos = j - current;
+                inChunk = false;
+            }
+            current = 0;
+        } else {
+            ++current;
+        }
+    }
+
+    if (longestSeqSize < current) {
+        assert(input.get(size - 1) == false);
+        input.set(size - 1, true);
+    } else if (inChunk) {
+        findInChunk(input, longestSeqPos, Width);
+    } else if (longestSeqPos == 0) {
+        assert(input.get(0) == false || longestSeqSize == 0);
+        input.set(0, true);
+    } else {
+        assert(input.get(longestSeqPos + longestSeqSize / 2) == false);
+        input.set(longestSeqPos + longestSeqSize / 2, true);
+    }
+}
+
+}
+
+template <size_t Width>
+void distanceMemoizedWidth(BoolVector& input) {
+    distanceMemoizedWidthImpl<Width, false>(input);
+}
+
+template void distanceMemoizedWidth<8>(BoolVector& input);
+template void distanceMemoizedWidth<9>(BoolVector& input);
+template void distanceMemoizedWidth<10>(BoolVector& input);
+template void distanceMemoizedWidth<11>(BoolVector& input);
+template void distanceMemoizedWidth<12>(BoolVector& input);
+template void distanceMemoizedWidth<13>(BoolVector& input);
+template void distanceMemoizedWidth<14>(BoolVector& input);
+template void distanceMemoizedWidth<15>(BoolVector& input);
+template void distanceMemoizedWidth<16>(BoolVector& input);
+
+#ifdef __AVX2__
+template <size_t Width>
+void distanceMemoizedWidthGather(BoolVector& input) {
+    distanceMemoizedWidthImpl<Width, true>(input);
+}
+
+template void distanceMemoizedWidthGather<8>(BoolVector& input);
+template void distanceMemoizedWidthGather<9>(BoolVector& input);
+template void distanceMemoizedWidthGather<10>(BoolVector& input);
+template void distanceMemoizedWidthGather<11>(BoolVector& input);
+template void distanceMemoizedWidthGather<12>(BoolVector& input);
+template void distanceMemoizedWidthGather<13>(BoolVector& input);
+template void distanceMemoizedWidthGather<14>(BoolVector& input);
+template void distanceMemoizedWidthGather<15>(BoolVector& input);
+template void distanceMemoizedWidthGather<16>(BoolVector& input);
+#endif
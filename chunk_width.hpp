@@ -0,0 +1,16 @@
+#pragma once
+
+#include "distance.hpp"
+
+
+// Memoized kernel on Width-bit chunks (8 to 16) with ChunkTable<Width> from memoized.hpp.
+// A separate kernel from distanceMemoized: 3-byte entries and chunks read with unaligned loads,
+// so even distanceMemoizedWidth<8> is not the same code.
+template <size_t Width>
+void distanceMemoizedWidth(BoolVector& input);
+
+// the same, chunks are looked up 8 at a time with AVX2 gathers
+#ifdef __AVX2__
+template <size_t Width>
+void distanceMemoizedWidthGather(BoolVector& input);
+#endif
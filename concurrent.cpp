@@ -0,0 +1,61 @@
+#include "concurrent.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+
+ConcurrentBoolVector::ConcurrentBoolVector(size_t size)
+    : m_size(size)
+    , m_wordsCount((size + 63) / 64)
+    , m_words(std::make_unique<std::atomic<uint64_t>[]>(m_wordsCount)) {
+    for (auto i = 0u; i != m_wordsCount; ++i) {
+        m_words[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+ConcurrentBoolVector::ConcurrentBoolVector(BoolVector const& input)
+    : ConcurrentBoolVector(input.size()) {
+    for (auto i = 0u; i != m_wordsCount; ++i) {
+        uint64_t word = 0;
+        std::memcpy(&word, input.rawData() + i * 8, std::min<size_t>(8, input.chunks() - i * 8));
+        if (i + 1 == m_wordsCount && m_size % 64 != 0) {
+            word &= mask(m_size) - 1;
+        }
+        m_words[i].store(word, std::memory_order_relaxed);
+    }
+}
+
+GapSummary ConcurrentBoolVector::summary() const {
+    std::array<uint64_t, SCAN_WORDS> snapshot;
+    GapSummary out{};
+    for (size_t i = 0; i < m_wordsCount; i += SCAN_WORDS) {
+        auto const words = std::min(SCAN_WORDS, m_wordsCount - i);
+        for (auto j = 0u; j != words; ++j) {
+            snapshot[j] = m_words[i + j].load(std::memory_order_acquire);
+        }
+        auto const begin = i * 64;
+        auto const bits = std::min(words * 64, m_size - begin);
+        out = merge(out, summarize(reinterpret_cast<const uint8_t*>(snapshot.data()), bits, begin));
+    }
+    return out;
+}
+
+std::optional<size_t> ConcurrentBoolVector::claimBestGap() {
+    while (true) {
+        auto const gap = summary();
+        if (gap.longest == 0) [[unlikely]] {
+            return std::nullopt;
+        }
+
+        auto const slot = bestSlot(gap);
+        auto& word = m_words[slot / 64];
+        auto expected = word.load(std::memory_order_relaxed);
+        while ((expected & mask(slot)) == 0) {
+            if (word.compare_exchange_weak(expected, expected | mask(slot), std::memory_order_acq_rel)) {
+                return slot;
+            }
+        }
+        // taken by another thread since the scan
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "distance.hpp"
+#include "memoized.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+
+// BoolVector with atomic words, several threads claim slots without a global lock.
+// Bit order is the same as in BoolVector.
+class ConcurrentBoolVector {
+public:
+    explicit ConcurrentBoolVector(size_t size);
+    explicit ConcurrentBoolVector(BoolVector const& input);
+
+    bool get(size_t index) const {
+        assert(index < size());
+        return (m_words[index / 64].load(std::memory_order_acquire) & mask(index)) != 0;
+    }
+
+    void set(size_t index, bool value) {
+        assert(index < size());
+        if (value) {
+            m_words[index / 64].fetch_or(mask(index), std::memory_order_acq_rel);
+        } else {
+            m_words[index / 64].fetch_and(~mask(index), std::memory_order_acq_rel);
+        }
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    // Sets the slot distanceMemoized would choose. The scan is optimistic: the bit is claimed with CAS,
+    // if another thread has taken it first the scan is repeated. Returns nullopt if there are no zeros.
+    std::optional<size_t> claimBestGap();
+
+    void release(size_t index) {
+        set(index, false);
+    }
+
+    // a snapshot, words can change during the scan
+    GapSummary summary() const;
+
+private:
+    static constexpr size_t SCAN_WORDS = 64;
+
+    size_t m_size;
+    size_t m_wordsCount;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_words;
+
+    static uint64_t mask(size_t index) {
+        return uint64_t{1} << (index % 64);
+    }
+};
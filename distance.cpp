@@ -1,7 +1,11 @@
 #include "distance.hpp"
+#include "memoized.hpp"
+#include "simd.hpp"
 
 #include <cassert>
 #include <array>
+#include <bit>
+#include <cstring>
 #include <iostream>
 #include <tuple>
 
@@ -36,6 +40,22 @@ void distanceSlow(std::vector<bool>& input) {
 }
 
 
+// libstdc++ keeps the bits in unsigned long words, the lowest bit first, the same order as BoolVector.
+// The debug mode wraps the iterators, so _M_p is not reachable there.
+void distanceVectorBool(std::vector<bool>& input) {
+#if defined(__GLIBCXX__) && !defined(_GLIBCXX_DEBUG) && __SIZEOF_LONG__ == 8 && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    assert(!input.empty());
+    auto* words = input.begin()._M_p;
+    static constexpr size_t WORD_BITS = sizeof(*words) * 8;
+
+    auto const slot = bestSlot(summarize(reinterpret_cast<const uint8_t*>(words), input.size()));
+    words[slot / WORD_BITS] |= std::_Bit_type{1} << (slot % WORD_BITS);
+#else
+    distanceSlow(input);
+#endif
+}
+
+
 void distanceUintSlow(std::vector<uint8_t>& input) {
     assert(!input.empty());
 
@@ -101,59 +121,12 @@ void distanceUintSlowBranchLess(std::vector<uint8_t>& input) {
     }
 }
 
-struct alignas(16) MemoizedData {
-    uint8_t l, m, r;
-};
-
-consteval MemoizedData analyzeBits(uint8_t value) {
-    assert(value != 0); // we use fixed value for 0 as {8, 8, 8}
-    uint8_t firstOne = 0, longestZero = 0, lastOne = 0;
-    uint8_t currentZero = 0;
-    bool foundOne = false;
-
-    for (uint8_t i = 0; i < 8; ++i) {
-        if (value & (1 << i)) {
-            if (!foundOne) {
-                firstOne = i;
-                foundOne = true;
-            }
-            longestZero = std::max(longestZero, currentZero);
-            currentZero = 0;
-            lastOne = i;
-        } else {
-            if (foundOne) {
-                currentZero++;
-            }
-        }
-    }
-
-    return {firstOne, longestZero, static_cast<uint8_t>(7 - lastOne)};
-}
-
-static constexpr auto UINT8_SIZE = (1 << 8) - 1;
-
-consteval auto gen() {
-    std::array<MemoizedData, UINT8_SIZE + 1> out{};
-    out[0] = {8, 8, 8};
-    for (uint8_t i = UINT8_SIZE; i != 0; --i) {
-        out[i] = analyzeBits(i);
-    }
-    return out;
-};
-
-// return prefix seq, internal seq, suffix seq
-decltype(auto) process8(uint8_t n) {
-    static constexpr auto cached = gen();
-    return cached[n];
-}
-
-
-void findInChunk(BoolVector& input, size_t pos) {
-    assert(pos % 8 == 0);
+void findInChunk(BoolVector& input, size_t pos, size_t width) {
+    assert(pos % width == 0);
     size_t longestSeqSize = 0;
     size_t longestSeqPos = 0;
     size_t current = 0;
-    for (auto i = pos; i != pos + 8; ++i) {
+    for (auto i = pos; i != pos + width; ++i) {
         auto t = input.get(i);
         if (t == 1) {
             if (longestSeqSize < current) {
@@ -170,7 +143,8 @@ void findInChunk(BoolVector& input, size_t pos) {
     input.set(longestSeqPos + longestSeqSize / 2, true);
 }
 
-void distanceMemoized(BoolVector& input) {
+template <typename Layout>
+void distanceMemoizedLayout(BoolVector& input) {
     auto const size = input.size();
     auto const chunks = input.fullChunks();
 
@@ -180,7 +154,7 @@ void distanceMemoized(BoolVector& input) {
     bool inChunk = false;
 
     for (auto i = 0u; i != chunks; ++i) {
-        auto [np, longest, ns] = process8(input.rawData()[i]);
+        auto [np, longest, ns] = Layout::get(input.rawData()[i]);
         if (np == 8) {
             current += 8;
         } else {
@@ -237,7 +211,17 @@ void distanceMemoized(BoolVector& input) {
     }
 }
 
-void distanceMemoizedBranchLess(BoolVector& input) {
+void distanceMemoized(BoolVector& input) {
+    distanceMemoizedLayout<PaddedLayout>(input);
+}
+
+template void distanceMemoizedLayout<PaddedLayout>(BoolVector& input);
+template void distanceMemoizedLayout<PackedLayout>(BoolVector& input);
+template void distanceMemoizedLayout<SoALayout>(BoolVector& input);
+template void distanceMemoizedLayout<BitPackedLayout>(BoolVector& input);
+
+template <typename Layout>
+void distanceMemoizedBranchLessLayout(BoolVector& input) {
     auto const size = input.size();
     auto const chunks = input.fullChunks();
 
@@ -247,7 +231,7 @@ void distanceMemoizedBranchLess(BoolVector& input) {
 
     static constexpr uint32_t IN_CHUNK_BIT = (1ull << 31);
     for (auto i = 0u; i != chunks; ++i) {
-        auto const& [np, longest, ns] = process8(input.rawData()[i]);
+        auto const& [np, longest, ns] = Layout::get(input.rawData()[i]);
 
         auto leftValue = np + current;
 
@@ -299,6 +283,91 @@ void distanceMemoizedBranchLess(BoolVector& input) {
     }
 }
 
+void distanceMemoizedBranchLess(BoolVector& input) {
+    distanceMemoizedBranchLessLayout<PaddedLayout>(input);
+}
+
+template void distanceMemoizedBranchLessLayout<PaddedLayout>(BoolVector& input);
+template void distanceMemoizedBranchLessLayout<PackedLayout>(BoolVector& input);
+template void distanceMemoizedBranchLessLayout<SoALayout>(BoolVector& input);
+template void distanceMemoizedBranchLessLayout<BitPackedLayout>(BoolVector& input);
+
+// Transition of the packed state for a byte: current = (current & -keep) + add
+struct PackedTransition {
+    uint8_t np, longest, add, keep;
+};
+
+consteval auto genTransitions() {
+    std::array<PackedTransition, UINT8_SIZE + 1> out{};
+    auto sourceTable = gen();
+    for (uint16_t i = 0; i != UINT8_SIZE + 1; ++i) {
+        auto [np, longest, ns] = sourceTable[i];
+        bool zeros = i == 0;
+        out[i] = {np, longest, zeros ? uint8_t{8} : ns, uint8_t{zeros}};
+    }
+    return out;
+}
+
+// The longest seq is one uint64_t: size in the high half, ~(pos * 2 + inChunk) in the low half,
+// so std::max picks the longest seq and the first one on ties.
+// Every byte offers the seq ending in it (or still going) and its internal seq,
+// the seq still going is offered again with a bigger size later.
+void distanceMemoizedPackedState(BoolVector& input) {
+    static constexpr auto transitions = genTransitions();
+    static constexpr uint64_t LOW_MASK = (1ull << 32) - 1;
+
+    auto const size = input.size();
+    auto const chunks = input.fullChunks();
+    // pos * 2 + inChunk must fit into the low 32 bits
+    if (size >= (1ull << 31)) [[unlikely]] {
+        distanceMemoized(input);
+        return;
+    }
+
+    auto seq = [](uint64_t seqSize, uint64_t pos2) {
+        return (seqSize << 32) | (LOW_MASK - pos2);
+    };
+
+    uint64_t current = 0;
+    uint64_t best = seq(0, 0);
+
+    for (auto i = 0u; i != chunks; ++i) {
+        auto const [np, longest, add, keep] = transitions[input.rawData()[i]];
+        auto const base = uint64_t{i} * 16;
+        auto const left = seq(current + np, base - current * 2);
+        auto const inner = seq(longest, base + 1);
+        best = std::max(best, std::max(left, inner));
+        current = (current & -uint64_t{keep}) + add;
+    }
+
+    for (auto j = chunks * 8; j != size; ++j) {
+        if (input.get(j)) {
+            best = std::max(best, seq(current, (j - current) * 2));
+            current = 0;
+        } else {
+            ++current;
+        }
+    }
+    best = std::max(best, seq(current, (size - current) * 2));
+
+    auto const longestSeqSize = best >> 32;
+    auto const pos2 = LOW_MASK - (best & LOW_MASK);
+    auto const longestSeqPos = pos2 / 2;
+
+    if (pos2 & 1) {
+        findInChunk(input, longestSeqPos);
+    } else if (longestSeqSize != 0 && longestSeqPos + longestSeqSize == size) {
+        assert(input.get(size - 1) == false);
+        input.set(size - 1, true);
+    } else if (longestSeqPos == 0) {
+        assert(input.get(0) == false || longestSeqSize == 0);
+        input.set(0, true);
+    } else {
+        assert(input.get(longestSeqPos + longestSeqSize / 2) == false);
+        input.set(longestSeqPos + longestSeqSize / 2, true);
+    }
+}
+
 #if __has_cpp_attribute(clang::code_align)
 #define CODE_ALIGN [[clang::code_align(64)]]
 #else
@@ -374,44 +443,92 @@ void distanceMemoizedAligned(BoolVector& input) {
     }
 }
 
-template <size_t Ind> requires(Ind < 3)
-constexpr auto genSingle(){
-    std::array<uint8_t, UINT8_SIZE + 1> out{};
-    auto sourceTable = gen();
-    for (uint16_t i = 0; i != UINT8_SIZE + 1; ++i) {
-        out[i] = std::get<Ind>(sourceTable[i]);
-    }
-    return out;
-};
 #if !__has_cpp_attribute(clang::code_align)
 #pragma GCC pop_options
 #endif
 
 
-#ifdef __AVX512F__
+namespace {
 
-void distanceMemoizedAVX(BoolVector& input) {
+// 0: prefix seq, 1: internal seq, 2: suffix seq
+consteval auto genNibbles(int kind) {
+    std::array<uint8_t, 16> out{};
+    for (uint8_t value = 0; value != 16; ++value) {
+        uint8_t prefix = 4, longest = 0, suffix = 4, current = 0;
+        bool foundOne = false;
+        for (uint8_t i = 0; i != 4; ++i) {
+            if (value & (1 << i)) {
+                if (!foundOne) {
+                    prefix = i;
+                }
+                longest = foundOne ? std::max(longest, current) : longest;
+                foundOne = true;
+                current = 0;
+                suffix = 3 - i;
+            } else {
+                ++current;
+            }
+        }
+        out[value] = kind == 0 ? prefix : (kind == 1 ? longest : suffix);
+    }
+    return out;
+}
+
+// prefix seq, internal seq and suffix seq of nibbles, 4 for the empty nibble
+constexpr auto NIBBLE_PREFIX = genNibbles(0);
+constexpr auto NIBBLE_INTERNAL = genNibbles(1);
+constexpr auto NIBBLE_SUFFIX = genNibbles(2);
+
+template <typename Ops>
+struct MemoizedReg {
+    typename Ops::Reg np, longest, ns;
+};
+
+// process8 for every byte, combined from the nibble tables
+template <typename Ops>
+[[gnu::always_inline]] inline MemoizedReg<Ops> process8Simd(typename Ops::Reg value) {
+    auto const zero = Ops::set1(0);
+    auto const [lo, hi] = simd::nibbles<Ops>(value);
+    auto const prefixTable = Ops::broadcast16(NIBBLE_PREFIX.data());
+    auto const suffixTable = Ops::broadcast16(NIBBLE_SUFFIX.data());
+    auto const internalTable = Ops::broadcast16(NIBBLE_INTERNAL.data());
+
+    auto const loZero = Ops::cmpeq(lo, zero);
+    auto const hiZero = Ops::cmpeq(hi, zero);
+    auto const npHi = Ops::shuffle(prefixTable, hi);
+    auto const nsLo = Ops::shuffle(suffixTable, lo);
+
+    auto const np = Ops::add(Ops::shuffle(prefixTable, lo), Ops::blend(zero, npHi, loZero));
+    auto const ns = Ops::add(Ops::shuffle(suffixTable, hi), Ops::blend(zero, nsLo, hiZero));
+
+    // the seq between the last one of the low nibble and the first one of the high nibble
+    auto middle = Ops::add(nsLo, npHi);
+    middle = Ops::blend(Ops::blend(middle, zero, loZero), zero, hiZero);
+    auto const longest = Ops::max(Ops::max(Ops::shuffle(internalTable, lo), Ops::shuffle(internalTable, hi)), middle);
+    return {np, longest, ns};
+}
+
+}
+
+// A block is skipped if none of its seqs can be longer than the current longest seq:
+// - the seq from the previous block goes through the leading zero bytes up to the first one,
+// - seqs inside a byte or between two non-zero neighbours are checked per lane,
+// - a seq over k zero bytes between two non-zero ones is at most 8 * k + 14,
+// - the trailing zero bytes only continue `current`.
+// Other blocks go byte by byte as in distanceMemoized.
+template <typename Ops>
+void distanceMemoizedSimd(BoolVector& input) {
     auto const size = input.size();
     auto const chunks = input.fullChunks();
+    auto const* data = input.rawData();
 
     size_t current = 0;
     size_t longestSeqSize = 0;
     size_t longestSeqPos = 0;
     bool inChunk = false;
 
-    auto i = 0u;
-    if (chunks > 64) {
-        auto const fixedChunks = chunks - (chunks % 64);
-        for (; i != fixedChunks; i += 64) {
-//            auto dataReg = _mm512_load_epi64(input.rawData() + i);
-//            auto lp = shuffle(dataReg, genSingle<0>());
-//            auto hp = shuffle(dataReg, genSingle<2>());
-
-        }
-    }
-
-    for (; i + 1 != chunks; ++i) {
-        auto [np, longest, ns] = process8(input.rawData()[i]);
+    auto step = [&](size_t i) {
+        auto [np, longest, ns] = process8(data[i]);
         if (np == 8) {
             current += 8;
         } else {
@@ -429,32 +546,81 @@ void distanceMemoizedAVX(BoolVector& input) {
             }
             current = ns;
         }
+    };
+
+    size_t i = 0;
+    if (chunks != 0) {
+        step(i++);
     }
 
-    for (auto j = (chunks - 1) * 8; j != size; ++j) {
-        auto t = input.get(j);
-        if (t == 1) {
-            if (longestSeqSize < current) {
-                longestSeqSize = current;
-                assert(j >= current);
-                longestSeqPos = j - current;
-                inChunk = false;
-            }
-            current = 0;
+    auto const zero = Ops::set1(0);
+    static constexpr uint64_t FULL_BLOCK = ~uint64_t{0} >> (64 - Ops::WIDTH);
+    // only the highest byte is used: ns of the byte before the block
+    auto prevNs = Ops::set1(chunks != 0 ? process8(data[0]).r : 0);
+    for (; i + Ops::WIDTH <= chunks; i += Ops::WIDTH) {
+        auto const value = Ops::load(data + i);
+        auto const [np, longest, ns] = process8Simd<Ops>(value);
+        auto const nsPrev = Ops::shiftInByte(ns, prevNs);
+        prevNs = ns;
+
+        auto const zeroBytes = Ops::movemask(Ops::cmpeq(value, zero));
+        if (zeroBytes == FULL_BLOCK) {
+            current += Ops::WIDTH * 8;
+            continue;
+        }
+        auto const leading = static_cast<size_t>(std::countr_one(zeroBytes));
+        auto const trailing = static_cast<size_t>(std::countl_one(zeroBytes << (64 - Ops::WIDTH)));
+        auto const last = Ops::WIDTH - 1 - trailing;
+
+        // zero bytes with non-zero ones on both sides
+        auto runs = zeroBytes & ~((uint64_t{1} << leading) - 1) & (FULL_BLOCK >> trailing);
+        size_t longestRun = 0;
+        for (; runs != 0; runs &= runs >> 1) {
+            ++longestRun;
+        }
+
+        auto const threshold = Ops::set1(static_cast<uint8_t>(std::min<size_t>(longestSeqSize, UINT8_SIZE)));
+        auto const candidate = Ops::max(Ops::add(nsPrev, np), longest);
+        bool const skip = current + leading * 8 + process8(data[i + leading]).l <= longestSeqSize
+                && (longestRun == 0 || longestRun * 8 + 14 <= longestSeqSize)
+                && simd::count<Ops>(Ops::cmple(candidate, threshold)) == Ops::WIDTH;
+        if (skip) [[likely]] {
+            current = trailing * 8 + process8(data[i + last]).r;
         } else {
-            ++current;
+            for (auto j = i; j != i + Ops::WIDTH; ++j) {
+                step(j);
+            }
+        }
+    }
+
+    for (; i != chunks; ++i) {
+        step(i);
+    }
+
+    if (size % 8 != 0) {
+        for (auto j = chunks * 8; j != size; ++j) {
+            auto t = input.get(j);
+            if (t == 1) {
+                if (longestSeqSize < current) {
+                    longestSeqSize = current;
+                    assert(j >= current);
+                    longestSeqPos = j - current;
+                    inChunk = false;
+                }
+                current = 0;
+            } else {
+                ++current;
+            }
         }
     }
 
     if (longestSeqSize < current) {
         assert(input.get(size - 1) == false);
         input.set(size - 1, true);
-        //std::cout << "end:" << longestSeqSize << std::endl;
     } else if (longestSeqPos == 0) {
         if (!inChunk) {
-            assert(input.get(0) != false && longestSeqSize != 0);
+            assert(input.get(0) == false || longestSeqSize == 0);
             input.set(0, true);
-            //std::cout << "0:" << longestSeqSize << std::endl;
         } else {
             findInChunk(input, longestSeqPos);
         }
@@ -462,11 +628,26 @@ void distanceMemoizedAVX(BoolVector& input) {
         if (!inChunk) {
             assert(input.get(longestSeqPos + longestSeqSize / 2) == false);
             input.set(longestSeqPos + longestSeqSize / 2, true);
-            //std::cout << "mid:" << longestSeqSize << std::endl;
         } else {
             findInChunk(input, longestSeqPos);
         }
     }
 }
 
+#ifdef __SSE4_2__
+void distanceMemoizedSSE(BoolVector& input) {
+    distanceMemoizedSimd<simd::SSE42>(input);
+}
+#endif
+
+#ifdef __AVX2__
+void distanceMemoizedAVX2(BoolVector& input) {
+    distanceMemoizedSimd<simd::AVX2>(input);
+}
+#endif
+
+#ifdef AVX512F
+void distanceMemoizedAVX(BoolVector& input) {
+    distanceMemoizedSimd<simd::AVX512>(input);
+}
 #endif
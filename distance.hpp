@@ -8,6 +8,9 @@
 
 void distanceSlow(std::vector<bool>& input);
 
+// memoized on the words of std::vector<bool> without a copy, distanceSlow if the layout is unknown
+void distanceVectorBool(std::vector<bool>& input);
+
 void distanceUintSlow(std::vector<uint8_t>& input);
 
 void distanceUintSlowBranchLess(std::vector<uint8_t>& input);
@@ -64,9 +67,40 @@ private:
 };
 
 
+// sets the middle of the longest internal seq of the `width`-bit chunk at `pos`
+void findInChunk(BoolVector& input, size_t pos, size_t width = 8);
+
 void distanceMemoized(BoolVector& input);
 void distanceMemoizedAligned(BoolVector& input);
 
 void distanceMemoizedBranchLess(BoolVector& input);
 
-void distanceMemoizedAVX(BoolVector& input);
\ No newline at end of file
+// branchless, the state is two uint64_t updated with max and masks.
+// Positions take 32 bits, inputs of 2^31 bits and more go to distanceMemoized.
+void distanceMemoizedPackedState(BoolVector& input);
+
+// table layouts, see memoized.hpp
+struct PaddedLayout;
+struct PackedLayout;
+struct SoALayout;
+struct BitPackedLayout;
+
+// distanceMemoized is distanceMemoizedLayout<PaddedLayout>
+template <typename Layout>
+void distanceMemoizedLayout(BoolVector& input);
+
+template <typename Layout>
+void distanceMemoizedBranchLessLayout(BoolVector& input);
+
+// memoized, blocks of bytes that can't change the longest seq are skipped with simd.hpp
+#ifdef __SSE4_2__
+void distanceMemoizedSSE(BoolVector& input);
+#endif
+
+#ifdef __AVX2__
+void distanceMemoizedAVX2(BoolVector& input);
+#endif
+
+#ifdef AVX512F
+void distanceMemoizedAVX(BoolVector& input);
+#endif
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "find_run.hpp"
+#include "memoized.hpp"
+
+#include <bit>
+#include <cstring>
+#include <limits>
+
+
+namespace {
+
+struct Fit {
+    size_t length;
+    FitPolicy policy;
+    size_t pos = 0;
+    size_t size = std::numeric_limits<size_t>::max();
+
+    // true if nothing better can be found
+    bool offer(size_t seqPos, size_t seqSize) {
+        if (seqSize < length || seqSize >= size) {
+            return false;
+        }
+        pos = seqPos;
+        size = seqSize;
+        return policy == FitPolicy::First || seqSize == length;
+    }
+
+    std::optional<size_t> result() const {
+        return size != std::numeric_limits<size_t>::max() ? std::optional{pos} : std::nullopt;
+    }
+};
+
+// internal seqs of the byte, only called if the longest of them fits
+bool offerInner(Fit& fit, uint8_t value, size_t begin) {
+    size_t current = 0;
+    bool foundOne = false;
+    for (auto i = 0u; i != 8; ++i) {
+        if (value & (1 << i)) {
+            if (foundOne && fit.offer(begin + i - current, current)) {
+                return true;
+            }
+            foundOne = true;
+            current = 0;
+        } else {
+            ++current;
+        }
+    }
+    return false;
+}
+
+}
+
+std::optional<size_t> findRunSlow(std::vector<bool> const& input, size_t length, FitPolicy policy) {
+    assert(length != 0);
+    Fit fit{length, policy};
+
+    size_t currentSeqSize = 0;
+    for (auto i = 0u; i != input.size(); ++i) {
+        if (input[i]) {
+            if (fit.offer(i - currentSeqSize, currentSeqSize)) {
+                return fit.result();
+            }
+            currentSeqSize = 0;
+        } else {
+            ++currentSeqSize;
+        }
+    }
+    fit.offer(input.size() - currentSeqSize, currentSeqSize);
+    return fit.result();
+}
+
+std::optional<size_t> findRun(BoolVector const& input, size_t length, FitPolicy policy) {
+    assert(length != 0);
+    auto const size = input.size();
+    auto const chunks = input.fullChunks();
+    auto const* data = input.rawData();
+    Fit fit{length, policy};
+
+    size_t current = 0;
+
+    // np == 8 is handled by the caller, `value` is masked for the tail chunk
+    auto processChunk = [&](size_t i, uint8_t value, uint8_t np, uint8_t longest, uint8_t ns) {
+        if (fit.offer(i * 8 - current, current + np)) {
+            return true;
+        }
+        if (longest >= length && offerInner(fit, value, i * 8)) [[unlikely]] {
+            return true;
+        }
+        current = ns;
+        return false;
+    };
+
+    static constexpr size_t WORD_CHUNKS = sizeof(uint64_t);
+    auto const words = chunks / WORD_CHUNKS;
+    if (length >= 64) {
+        // seqs between two ones of a word are shorter than 64, only the first one of a word matters
+        for (size_t w = 0; w != words; ++w) {
+            uint64_t word;
+            std::memcpy(&word, data + w * WORD_CHUNKS, sizeof(word));
+            if (word == 0) {
+                current += 64;
+            } else {
+                auto const tz = static_cast<size_t>(std::countr_zero(word));
+                if (fit.offer(w * 64 - current, current + tz)) {
+                    return fit.result();
+                }
+                current = static_cast<size_t>(std::countl_zero(word));
+            }
+        }
+    } else {
+        for (size_t w = 0; w != words; ++w) {
+            uint64_t word;
+            std::memcpy(&word, data + w * WORD_CHUNKS, sizeof(word));
+            if (word == 0) {
+                current += 64;
+            } else if (word == ~uint64_t{0}) {
+                if (fit.offer(w * 64 - current, current)) {
+                    return fit.result();
+                }
+                current = 0;
+            } else {
+                for (auto i = w * WORD_CHUNKS; i != (w + 1) * WORD_CHUNKS; ++i) {
+                    auto [np, longest, ns] = process8(data[i]);
+                    if (np == 8) {
+                        current += 8;
+                    } else if (processChunk(i, data[i], np, longest, ns)) {
+                        return fit.result();
+                    }
+                }
+            }
+        }
+    }
+
+    for (auto i = words * WORD_CHUNKS; i != chunks; ++i) {
+        auto [np, longest, ns] = process8(data[i]);
+        if (np == 8) {
+            current += 8;
+        } else if (processChunk(i, data[i], np, longest, ns)) {
+            return fit.result();
+        }
+    }
+
+    if (auto const tail = size % 8; tail != 0) {
+        auto const value = static_cast<uint8_t>(data[chunks] & ((1u << tail) - 1));
+        if (value == 0) {
+            current += tail;
+        } else {
+            auto [np, longest, ns] = process8(value);
+            if (processChunk(chunks, value, np, longest, ns - (8 - tail))) {
+                return fit.result();
+            }
+        }
+    }
+
+    fit.offer(size - current, current);
+    return fit.result();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "distance.hpp"
+
+#include <optional>
+#include <vector>
+
+
+enum class FitPolicy {
+    First, // the first seq of `0` with size >= length
+    Best, // the shortest seq with size >= length, the first one on ties
+};
+
+// Start of the chosen seq of at least `length` zeros, nullopt if there is no such seq.
+std::optional<size_t> findRunSlow(std::vector<bool> const& input, size_t length, FitPolicy policy);
+
+std::optional<size_t> findRun(BoolVector const& input, size_t length, FitPolicy policy);
@@ -0,0 +1,239 @@
+#include "histogram.hpp"
+#include "memoized.hpp"
+
+#include <bit>
+#include <cstring>
+#include <thread>
+
+
+namespace {
+
+// 8-bit lane `size` holds the count of internal seqs of that size (1..6), at most 3 per byte
+consteval auto genInnerCounts() {
+    std::array<uint64_t, UINT8_SIZE + 1> out{};
+    for (uint16_t value = 1; value != UINT8_SIZE + 1; ++value) {
+        uint64_t counts = 0;
+        size_t current = 0;
+        bool foundOne = false;
+        for (auto i = 0u; i != 8; ++i) {
+            if (value & (1 << i)) {
+                if (foundOne && current != 0) {
+                    counts += uint64_t{1} << (8 * current);
+                }
+                foundOne = true;
+                current = 0;
+            } else {
+                ++current;
+            }
+        }
+        out[value] = counts;
+    }
+    return out;
+}
+
+}
+
+void GapHistogram::add(size_t seqSize, uint64_t count) {
+    assert(seqSize != 0);
+    seqs += count;
+    zeros += seqSize * count;
+    if (seqSize <= EXACT) {
+        exact[seqSize] += count;
+    }
+    log2[std::bit_width(seqSize) - 1] += count;
+}
+
+GapHistogram& GapHistogram::operator+=(GapHistogram const& rhs) {
+    for (auto i = 0u; i != exact.size(); ++i) {
+        exact[i] += rhs.exact[i];
+    }
+    for (auto i = 0u; i != log2.size(); ++i) {
+        log2[i] += rhs.log2[i];
+    }
+    seqs += rhs.seqs;
+    zeros += rhs.zeros;
+    return *this;
+}
+
+GapHistogram GapHistogramSegment::finish() const {
+    auto out = inner;
+    if (size == 0) {
+        return out;
+    }
+    if (zeros()) {
+        out.add(size);
+    } else {
+        if (prefix != 0) {
+            out.add(prefix);
+        }
+        if (suffix != 0) {
+            out.add(suffix);
+        }
+    }
+    return out;
+}
+
+// One scalar pass: zero words are skipped, the internal seqs of a byte (at most 3, sizes 1..6) are counted
+// with one add of a packed 8-bit-lane counter instead of a byte table lookup per seq.
+GapHistogramSegment histogramSegment(const uint8_t* data, size_t bits) {
+    static constexpr auto innerCounts = genInnerCounts();
+    // a lane gets at most 3 per byte, so 64 bytes fit into 8 bits
+    static constexpr size_t FLUSH_CHUNKS = 64;
+
+    GapHistogramSegment out;
+    out.size = bits;
+
+    size_t current = 0;
+    bool foundOne = false;
+    uint64_t lanes = 0;
+    size_t lanesChunks = 0;
+    // short seqs are counted here and added to the histogram once
+    std::array<uint64_t, 64 + 1> counts{};
+
+    auto flush = [&] {
+        for (auto seqSize = 1u; seqSize != 7; ++seqSize) {
+            counts[seqSize] += (lanes >> (8 * seqSize)) & 0xff;
+        }
+        lanes = 0;
+        lanesChunks = 0;
+    };
+
+    // `value` has ones, its bits above `valid` are zero
+    auto processChunk = [&](uint8_t value, size_t valid) {
+        auto [np, longest, ns] = process8(value);
+        auto const seqSize = current + np;
+        if (!foundOne) [[unlikely]] {
+            out.prefix = seqSize;
+            foundOne = true;
+        } else if (seqSize < counts.size()) {
+            ++counts[seqSize];
+        } else {
+            out.inner.add(seqSize);
+        }
+        if (longest != 0) {
+            lanes += innerCounts[value];
+            if (++lanesChunks == FLUSH_CHUNKS) [[unlikely]] {
+                flush();
+            }
+        }
+        current = ns - (8 - valid);
+    };
+
+    auto const chunks = bits / 8;
+    auto const words = chunks / sizeof(uint64_t);
+    for (auto w = 0u; w != words; ++w) {
+        uint64_t word;
+        std::memcpy(&word, data + w * sizeof(word), sizeof(word));
+        if (word == 0) {
+            current += 64;
+            continue;
+        }
+        for (auto i = w * sizeof(word); i != (w + 1) * sizeof(word); ++i) {
+            if (data[i] == 0) {
+                current += 8;
+            } else {
+                processChunk(data[i], 8);
+            }
+        }
+    }
+
+    for (auto i = words * sizeof(uint64_t); i != chunks; ++i) {
+        if (data[i] == 0) {
+            current += 8;
+        } else {
+            processChunk(data[i], 8);
+        }
+    }
+
+    if (auto const tail = bits % 8; tail != 0) {
+        auto const value = static_cast<uint8_t>(data[chunks] & ((1u << tail) - 1));
+        if (value == 0) {
+            current += tail;
+        } else {
+            processChunk(value, tail);
+        }
+    }
+
+    flush();
+    for (auto seqSize = 1u; seqSize != counts.size(); ++seqSize) {
+        if (counts[seqSize] != 0) {
+            out.inner.add(seqSize, counts[seqSize]);
+        }
+    }
+    if (!foundOne) {
+        out.prefix = bits;
+    }
+    out.suffix = foundOne ? current : bits;
+    return out;
+}
+
+GapHistogramSegment merge(GapHistogramSegment const& lhs, GapHistogramSegment const& rhs) {
+    if (lhs.size == 0) {
+        return rhs;
+    } else if (rhs.size == 0) {
+        return lhs;
+    }
+
+    GapHistogramSegment out;
+    out.inner = lhs.inner;
+    out.inner += rhs.inner;
+    out.size = lhs.size + rhs.size;
+    out.prefix = lhs.zeros() ? lhs.size + rhs.prefix : lhs.prefix;
+    out.suffix = rhs.zeros() ? rhs.size + lhs.suffix : rhs.suffix;
+
+    auto const joined = lhs.suffix + rhs.prefix;
+    if (!lhs.zeros() && !rhs.zeros() && joined != 0) {
+        out.inner.add(joined);
+    }
+    return out;
+}
+
+GapHistogram gapHistogramSlow(std::vector<bool> const& input) {
+    GapHistogram out;
+    size_t currentSeqSize = 0;
+    for (auto i = 0u; i != input.size(); ++i) {
+        if (input[i]) {
+            if (currentSeqSize != 0) {
+                out.add(currentSeqSize);
+            }
+            currentSeqSize = 0;
+        } else {
+            ++currentSeqSize;
+        }
+    }
+    if (currentSeqSize != 0) {
+        out.add(currentSeqSize);
+    }
+    return out;
+}
+
+GapHistogram gapHistogram(BoolVector const& input) {
+    return histogramSegment(input.rawData(), input.size()).finish();
+}
+
+GapHistogram gapHistogram(BoolVector const& input, size_t threads) {
+    static constexpr size_t SEGMENT_ALIGN = 64;
+    assert(threads != 0);
+
+    auto const chunks = input.chunks();
+    auto const segmentChunks = ((chunks + threads - 1) / threads + SEGMENT_ALIGN - 1) / SEGMENT_ALIGN * SEGMENT_ALIGN;
+
+    std::vector<GapHistogramSegment> segments(threads);
+    std::vector<std::thread> workers;
+    for (auto t = 0u; t != threads && t * segmentChunks < chunks; ++t) {
+        auto const beginBit = t * segmentChunks * 8;
+        auto const bits = std::min(segmentChunks * 8, input.size() - beginBit);
+        workers.emplace_back([&out = segments[t], data = input.rawData() + t * segmentChunks, bits] {
+            out = histogramSegment(data, bits);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    GapHistogramSegment out;
+    for (auto const& segment : segments) {
+        out = merge(out, segment);
+    }
+    return out.finish();
+}
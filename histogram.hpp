@@ -0,0 +1,50 @@
+#pragma once
+
+#include "distance.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+// Distribution of the seq of `0` sizes
+struct GapHistogram {
+    static constexpr size_t EXACT = 16;
+
+    std::array<uint64_t, EXACT + 1> exact{}; // exact[size] for size <= EXACT, exact[0] is unused
+    std::array<uint64_t, 64> log2{}; // log2[k] for size in [2^k, 2^(k+1)), every seq
+    uint64_t seqs = 0;
+    uint64_t zeros = 0;
+
+    void add(size_t seqSize, uint64_t count = 1);
+
+    GapHistogram& operator+=(GapHistogram const& rhs);
+
+    bool operator==(GapHistogram const&) const = default;
+};
+
+// Histogram of a segment, the seqs touching its borders are kept apart to be stitched with the neighbours.
+struct GapHistogramSegment {
+    GapHistogram inner; // seqs with ones on both sides
+    size_t size = 0;
+    size_t prefix = 0;
+    size_t suffix = 0;
+
+    bool zeros() const {
+        return prefix == size;
+    }
+
+    GapHistogram finish() const;
+};
+
+GapHistogramSegment histogramSegment(const uint8_t* data, size_t bits);
+
+// `rhs` must start right after `lhs`
+GapHistogramSegment merge(GapHistogramSegment const& lhs, GapHistogramSegment const& rhs);
+
+GapHistogram gapHistogramSlow(std::vector<bool> const& input);
+
+GapHistogram gapHistogram(BoolVector const& input);
+
+// segments are processed by `threads` threads and merged
+GapHistogram gapHistogram(BoolVector const& input, size_t threads);
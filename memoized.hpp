@@ -0,0 +1,337 @@
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+
+struct alignas(16) MemoizedData {
+    uint8_t l, m, r;
+};
+
+consteval MemoizedData analyzeBits(uint8_t value) {
+    assert(value != 0); // we use fixed value for 0 as {8, 8, 8}
+    uint8_t firstOne = 0, longestZero = 0, lastOne = 0;
+    uint8_t currentZero = 0;
+    bool foundOne = false;
+
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (value & (1 << i)) {
+            if (!foundOne) {
+                firstOne = i;
+                foundOne = true;
+            }
+            longestZero = std::max(longestZero, currentZero);
+            currentZero = 0;
+            lastOne = i;
+        } else {
+            if (foundOne) {
+                currentZero++;
+            }
+        }
+    }
+
+    return {firstOne, longestZero, static_cast<uint8_t>(7 - lastOne)};
+}
+
+static constexpr auto UINT8_SIZE = (1 << 8) - 1;
+
+consteval auto gen() {
+    std::array<MemoizedData, UINT8_SIZE + 1> out{};
+    out[0] = {8, 8, 8};
+    for (uint8_t i = UINT8_SIZE; i != 0; --i) {
+        out[i] = analyzeBits(i);
+    }
+    return out;
+};
+
+// return prefix seq, internal seq, suffix seq
+inline decltype(auto) process8(uint8_t n) {
+    static constexpr auto cached = gen();
+    return cached[n];
+}
+
+template <size_t Ind> requires(Ind < 3)
+constexpr auto genSingle() {
+    std::array<uint8_t, UINT8_SIZE + 1> out{};
+    auto sourceTable = gen();
+    for (uint16_t i = 0; i != UINT8_SIZE + 1; ++i) {
+        auto const& data = sourceTable[i];
+        out[i] = Ind == 0 ? data.l : (Ind == 1 ? data.m : data.r);
+    }
+    return out;
+};
+
+// Table layouts for the memoized kernels, get() returns prefix seq, internal seq, suffix seq.
+struct PackedData {
+    uint8_t l, m, r;
+};
+static_assert(sizeof(PackedData) == 3);
+
+// MemoizedData as is: 16 bytes per entry, 4 Kb
+struct PaddedLayout {
+    static decltype(auto) get(uint8_t n) {
+        return process8(n);
+    }
+};
+
+// 3 bytes per entry, 768 b
+struct PackedLayout {
+    static constexpr auto table = [] {
+        std::array<PackedData, UINT8_SIZE + 1> out{};
+        auto sourceTable = gen();
+        for (uint16_t i = 0; i != UINT8_SIZE + 1; ++i) {
+            out[i] = {sourceTable[i].l, sourceTable[i].m, sourceTable[i].r};
+        }
+        return out;
+    }();
+
+    static PackedData get(uint8_t n) {
+        return table[n];
+    }
+};
+
+// 3 tables of 256 b
+struct SoALayout {
+    alignas(64) static constexpr auto prefix = genSingle<0>();
+    alignas(64) static constexpr auto internal = genSingle<1>();
+    alignas(64) static constexpr auto suffix = genSingle<2>();
+
+    static PackedData get(uint8_t n) {
+        return {prefix[n], internal[n], suffix[n]};
+    }
+};
+
+// 4 bits per value in uint32_t, 1 Kb
+struct BitPackedLayout {
+    static constexpr auto table = [] {
+        std::array<uint32_t, UINT8_SIZE + 1> out{};
+        auto sourceTable = gen();
+        for (uint16_t i = 0; i != UINT8_SIZE + 1; ++i) {
+            out[i] = sourceTable[i].l | (sourceTable[i].m << 4) | (sourceTable[i].r << 8);
+        }
+        return out;
+    }();
+
+    static PackedData get(uint8_t n) {
+        auto const value = table[n];
+        return {static_cast<uint8_t>(value & 0xf), static_cast<uint8_t>((value >> 4) & 0xf), static_cast<uint8_t>(value >> 8)};
+    }
+};
+
+template <size_t Width> requires(Width >= 8 && Width <= 16)
+struct ChunkTable;
+
+// 3 bytes per entry and one byte more, so every entry can be read with a 4-byte load.
+// The table of Width bits is the table of Width - 1 bits with one more high bit,
+// so every step costs a few ops per entry and stays far from the constexpr ops limit.
+template <size_t Width>
+consteval auto genChunk() {
+    std::array<uint8_t, 3 * (size_t{1} << Width) + 1> out{};
+    // raw pointers, operator[] calls make the evaluation several times slower in gcc
+    auto* dst = out.data();
+    if constexpr (Width == 8) {
+        auto const bytes = gen();
+        for (uint32_t value = 0; value != (uint32_t{1} << Width); ++value) {
+            dst[3 * value] = bytes[value].l;
+            dst[3 * value + 1] = bytes[value].m;
+            dst[3 * value + 2] = bytes[value].r;
+        }
+    } else {
+        constexpr uint32_t HALF = uint32_t{1} << (Width - 1);
+        auto const* low = ChunkTable<Width - 1>::table.data();
+        // high bit is 0: the suffix grows by one
+        dst[0] = dst[1] = dst[2] = Width;
+        for (uint32_t value = 1; value != HALF; ++value) {
+            dst[3 * value] = low[3 * value];
+            dst[3 * value + 1] = low[3 * value + 1];
+            dst[3 * value + 2] = low[3 * value + 2] + 1;
+        }
+        // high bit is 1: the suffix becomes internal
+        dst[3 * HALF] = Width - 1;
+        dst[3 * HALF + 1] = 0;
+        dst[3 * HALF + 2] = 0;
+        for (uint32_t value = 1; value != HALF; ++value) {
+            dst[3 * (HALF + value)] = low[3 * value];
+            dst[3 * (HALF + value) + 1] = std::max(low[3 * value + 1], low[3 * value + 2]);
+            dst[3 * (HALF + value) + 2] = 0;
+        }
+    }
+    return out;
+}
+
+// Table for Width-bit chunks: 768 b for 8 bits, 12 Kb for 12 bits, 192 Kb for 16 bits
+template <size_t Width> requires(Width >= 8 && Width <= 16)
+struct ChunkTable {
+    static constexpr uint32_t MASK = (uint32_t{1} << Width) - 1;
+
+    alignas(64) static constexpr auto table = genChunk<Width>();
+
+    static PackedData get(uint32_t value) {
+        return {table[3 * value], table[3 * value + 1], table[3 * value + 2]};
+    }
+};
+
+// offset of the longest internal seq (between two ones) of the byte, the first one on ties
+inline uint8_t innerSeqPos(uint8_t value) {
+    uint8_t longestSeqSize = 0, longestSeqPos = 0;
+    uint8_t current = 0;
+    bool foundOne = false;
+    for (uint8_t i = 0; i != 8; ++i) {
+        if (value & (1 << i)) {
+            if (foundOne && longestSeqSize < current) {
+                longestSeqSize = current;
+                longestSeqPos = i - current;
+            }
+            foundOne = true;
+            current = 0;
+        } else {
+            ++current;
+        }
+    }
+    return longestSeqPos;
+}
+
+// Summary of a bit segment that can be merged with its neighbours.
+// Positions are absolute, so merging never has to rebase the longest seq.
+struct GapSummary {
+    size_t begin = 0;
+    size_t size = 0;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    size_t longest = 0;
+    size_t longestPos = 0; // begin of the chunk if inChunk, resolve with innerSeqPos
+    bool inChunk = false;
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    bool zeros() const {
+        return prefix == size;
+    }
+};
+
+// `bits` low bits of value starting at absolute position `begin`, bits above must be zero
+inline GapSummary summarize8(uint8_t value, size_t begin, uint8_t bits = 8) {
+    assert(bits != 0 && bits <= 8);
+    assert(bits == 8 || (value >> bits) == 0);
+    if (value == 0) {
+        return {begin, bits, bits, bits, bits, begin, false};
+    }
+
+    auto [np, longest, ns] = process8(value);
+    ns -= 8 - bits;
+    GapSummary out{begin, bits, np, ns, np, begin, false};
+    if (longest > out.longest) {
+        out.longest = longest;
+        out.inChunk = true;
+    }
+    if (ns > out.longest) {
+        out.longest = ns;
+        out.longestPos = begin + bits - ns;
+        out.inChunk = false;
+    }
+    return out;
+}
+
+// `rhs` must start right after `lhs`, the first longest seq wins on ties
+inline GapSummary merge(GapSummary const& lhs, GapSummary const& rhs) {
+    if (lhs.empty()) {
+        return rhs;
+    } else if (rhs.empty()) {
+        return lhs;
+    }
+    assert(lhs.begin + lhs.size == rhs.begin);
+
+    GapSummary out = lhs;
+    out.size = lhs.size + rhs.size;
+    out.prefix = lhs.zeros() ? lhs.size + rhs.prefix : lhs.prefix;
+    out.suffix = rhs.zeros() ? rhs.size + lhs.suffix : rhs.suffix;
+
+    auto joined = lhs.suffix + rhs.prefix;
+    if (joined > out.longest) {
+        out.longest = joined;
+        out.longestPos = rhs.begin - lhs.suffix;
+        out.inChunk = false;
+    }
+    if (rhs.longest > out.longest) {
+        out.longest = rhs.longest;
+        out.longestPos = rhs.longestPos;
+        out.inChunk = rhs.inChunk;
+    }
+    return out;
+}
+
+// Summary of `bits` bits of data, positions start from `begin`. The longest seq is resolved.
+inline GapSummary summarize(const uint8_t* data, size_t bits, size_t begin = 0) {
+    auto const chunks = bits / 8;
+
+    size_t current = 0;
+    size_t prefix = bits;
+    size_t longestSeqSize = 0;
+    size_t longestSeqPos = 0;
+    bool inChunk = false;
+
+    auto step = [&](size_t i, size_t np, size_t longest, size_t ns) {
+        auto lp = np + current;
+        if (prefix == bits) [[unlikely]] {
+            prefix = lp;
+        }
+        if (lp > longestSeqSize) [[unlikely]] {
+            longestSeqSize = lp;
+            longestSeqPos = i * 8 + np - longestSeqSize;
+            inChunk = false;
+        }
+        if (longest > longestSeqSize) [[unlikely]] {
+            inChunk = true;
+            longestSeqSize = longest;
+            longestSeqPos = i * 8;
+        }
+        current = ns;
+    };
+
+    for (auto i = 0u; i != chunks; ++i) {
+        auto [np, longest, ns] = process8(data[i]);
+        if (np == 8) {
+            current += 8;
+        } else {
+            step(i, np, longest, ns);
+        }
+    }
+
+    // bits after the end can be garbage
+    auto const tailValue = static_cast<uint8_t>(bits % 8 != 0 ? data[chunks] & ((1u << (bits % 8)) - 1) : 0);
+    if (auto const tail = bits % 8; tail != 0) {
+        if (tailValue == 0) {
+            current += tail;
+        } else {
+            auto [np, longest, ns] = process8(tailValue);
+            step(chunks, np, longest, ns - (8 - tail));
+        }
+    }
+
+    if (longestSeqSize < current) {
+        longestSeqSize = current;
+        longestSeqPos = bits - current;
+        inChunk = false;
+    }
+    if (inChunk) {
+        longestSeqPos += innerSeqPos(longestSeqPos / 8 == chunks ? tailValue : data[longestSeqPos / 8]);
+    }
+    return {begin, bits, prefix, current, longestSeqSize, begin + longestSeqPos, false};
+}
+
+// the position distanceMemoized sets for the segment
+inline size_t bestSlot(GapSummary const& summary) {
+    assert(!summary.empty() && !summary.inChunk);
+    if (summary.longest != 0 && summary.longestPos + summary.longest == summary.begin + summary.size) {
+        return summary.begin + summary.size - 1;
+    } else if (summary.longestPos == summary.begin) {
+        return summary.begin;
+    } else {
+        return summary.longestPos + summary.longest / 2;
+    }
+}
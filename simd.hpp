@@ -2,72 +2,262 @@
 
 #include <immintrin.h>
 #include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 
-#ifdef AVX512F
+// Byte-vector operations with one backend per register width, kernels are templates over the backend.
+// Mask is what comparisons return: a vector for SSE/AVX2, a k-register for AVX-512.
+// shuffle() looks up a 16-entry table (see broadcast16) independently in every 128-bit lane.
+namespace simd {
 
 static constexpr auto TABLE_SIZE = 256;
 
-namespace {
-[[gnu::always_inline]] inline __m512i load_value(uint8_t fill) {
-    return _mm512_set1_epi8(fill);
-}
+#ifdef __SSE4_2__
 
-inline __m512i blend(__m512i a, __m512i b, __mmask64 mask) {
-    return _mm512_mask_blend_epi8(mask, a, b);
-}
+struct SSE42 {
+    using Reg = __m128i;
+    using Mask = __m128i;
+    static constexpr size_t WIDTH = 16;
 
-}
+    static Reg load(const uint8_t* src) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    }
 
-[[gnu::always_inline]] inline __m512i shuffle(__m512i src, std::array<uint8_t, TABLE_SIZE> lookupTable) {
-    static constexpr auto REG_SIZE = 64;
-    auto l1 = _mm512_load_epi64(lookupTable.data());
-    auto l2 = _mm512_load_epi64(lookupTable.data() + REG_SIZE);
-    auto grt2 = load_value(REG_SIZE);
-    auto l3 = _mm512_load_epi64(lookupTable.data() + REG_SIZE * 2);
-    auto grt3 = load_value(REG_SIZE * 2);
-    auto l4 = _mm512_load_epi64(lookupTable.data() + REG_SIZE * 3);
-    auto grt4 = load_value(REG_SIZE * 2);
-
-    auto result1 = _mm512_shuffle_epi8(l1, src);
-    auto result2 = _mm512_shuffle_epi8(l2, src);
-    auto result3 = _mm512_shuffle_epi8(l3, src);
-    auto result4 = _mm512_shuffle_epi8(l4, src);
-
-    auto select2 = _mm512_cmpge_epi8_mask(src, grt2);
-    auto select3 = _mm512_cmpge_epi8_mask(src, grt3);
-    auto select4 = _mm512_cmpge_epi8_mask(src, grt4);
-
-    auto fixedResult1 = blend(result1, result2, select2);
-    auto fixedResult2 = blend(fixedResult1, result3, select3);
-    auto fixedResult3 = blend(fixedResult2, result4, select4);
-
-    return fixedResult3;
-}
+    static void store(uint8_t* dst, Reg value) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+    }
 
+    static Reg set1(uint8_t fill) {
+        return _mm_set1_epi8(static_cast<char>(fill));
+    }
 
-namespace {
+    static Reg broadcast16(const uint8_t* table) {
+        return load(table);
+    }
 
-inline __m256i blend(__m256i a, __m256i b, __mmask32 mask) {
-    return _mm256_mask_blend_epi8(mask, a, b);
-}
+    static Reg bitAnd(Reg a, Reg b) {
+        return _mm_and_si128(a, b);
+    }
 
-}
+    template <int N>
+    static Reg srli16(Reg a) {
+        return _mm_srli_epi16(a, N);
+    }
 
-template <size_t TABLE_SIZE>
-[[gnu::always_inline]] inline __m256i shuffle(__m256i src, std::array<uint8_t, TABLE_SIZE> lookupTable) {
-    static constexpr auto REG_SIZE = 32;
-    auto resultReg = _mm256_set1_epi8(0);
+    static Reg add(Reg a, Reg b) {
+        return _mm_add_epi8(a, b);
+    }
 
-    for (auto i = 0u; i != TABLE_SIZE / REG_SIZE; ++i) {
-        auto tableReg = _mm256_load_epi64(lookupTable.data() + i * REG_SIZE);
-        auto resultTmpReg = _mm256_shuffle_epi8(tableReg, src);
-        auto borderReg = _mm256_set1_epi8(i * REG_SIZE);
-        auto selectReg = _mm256_cmpge_epi8_mask(src, borderReg);
-        resultReg = blend(resultReg, resultTmpReg, selectReg);
+    static Reg max(Reg a, Reg b) {
+        return _mm_max_epu8(a, b);
     }
 
-    return resultReg;
-}
+    static Mask cmpeq(Reg a, Reg b) {
+        return _mm_cmpeq_epi8(a, b);
+    }
+
+    // unsigned a <= b
+    static Mask cmple(Reg a, Reg b) {
+        return _mm_cmpeq_epi8(_mm_max_epu8(a, b), b);
+    }
+
+    // b where mask is set, a otherwise
+    static Reg blend(Reg a, Reg b, Mask mask) {
+        return _mm_blendv_epi8(a, b, mask);
+    }
+
+    static uint64_t movemask(Mask mask) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(mask));
+    }
+
+    static Reg shuffle(Reg table, Reg index) {
+        return _mm_shuffle_epi8(table, index);
+    }
+
+    // bytes moved one position up, the lowest one is the highest byte of prev
+    static Reg shiftInByte(Reg value, Reg prev) {
+        return _mm_alignr_epi8(value, prev, 15);
+    }
+};
+
+#endif
+
+#ifdef __AVX2__
+
+struct AVX2 {
+    using Reg = __m256i;
+    using Mask = __m256i;
+    static constexpr size_t WIDTH = 32;
+
+    static Reg load(const uint8_t* src) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    }
+
+    static void store(uint8_t* dst, Reg value) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value);
+    }
+
+    static Reg set1(uint8_t fill) {
+        return _mm256_set1_epi8(static_cast<char>(fill));
+    }
+
+    static Reg broadcast16(const uint8_t* table) {
+        return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+    }
+
+    static Reg bitAnd(Reg a, Reg b) {
+        return _mm256_and_si256(a, b);
+    }
+
+    template <int N>
+    static Reg srli16(Reg a) {
+        return _mm256_srli_epi16(a, N);
+    }
+
+    static Reg add(Reg a, Reg b) {
+        return _mm256_add_epi8(a, b);
+    }
+
+    static Reg max(Reg a, Reg b) {
+        return _mm256_max_epu8(a, b);
+    }
+
+    static Mask cmpeq(Reg a, Reg b) {
+        return _mm256_cmpeq_epi8(a, b);
+    }
+
+    static Mask cmple(Reg a, Reg b) {
+        return _mm256_cmpeq_epi8(_mm256_max_epu8(a, b), b);
+    }
+
+    static Reg blend(Reg a, Reg b, Mask mask) {
+        return _mm256_blendv_epi8(a, b, mask);
+    }
+
+    static uint64_t movemask(Mask mask) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(mask));
+    }
+
+    static Reg shuffle(Reg table, Reg index) {
+        return _mm256_shuffle_epi8(table, index);
+    }
+
+    // alignr works in 128-bit lanes, the lane below is [prev.hi, value.lo]
+    static Reg shiftInByte(Reg value, Reg prev) {
+        return _mm256_alignr_epi8(value, _mm256_permute2x128_si256(prev, value, 0x21), 15);
+    }
+};
+
+#endif
+
+#ifdef AVX512F
+
+struct AVX512 {
+    using Reg = __m512i;
+    using Mask = __mmask64;
+    static constexpr size_t WIDTH = 64;
+
+    static Reg load(const uint8_t* src) {
+        return _mm512_loadu_si512(src);
+    }
+
+    static void store(uint8_t* dst, Reg value) {
+        _mm512_storeu_si512(dst, value);
+    }
+
+    static Reg set1(uint8_t fill) {
+        return _mm512_set1_epi8(static_cast<char>(fill));
+    }
+
+    static Reg broadcast16(const uint8_t* table) {
+        // the unmasked form trips -Wmaybe-uninitialized inside gcc's own header
+        return _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(-1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(table)));
+    }
+
+    static Reg bitAnd(Reg a, Reg b) {
+        return _mm512_and_si512(a, b);
+    }
+
+    template <int N>
+    static Reg srli16(Reg a) {
+        return _mm512_srli_epi16(a, N);
+    }
+
+    static Reg add(Reg a, Reg b) {
+        return _mm512_add_epi8(a, b);
+    }
+
+    static Reg max(Reg a, Reg b) {
+        return _mm512_max_epu8(a, b);
+    }
+
+    static Mask cmpeq(Reg a, Reg b) {
+        return _mm512_cmpeq_epi8_mask(a, b);
+    }
+
+    static Mask cmple(Reg a, Reg b) {
+        return _mm512_cmple_epu8_mask(a, b);
+    }
+
+    static Reg blend(Reg a, Reg b, Mask mask) {
+        return _mm512_mask_blend_epi8(mask, a, b);
+    }
+
+    static uint64_t movemask(Mask mask) {
+        return mask;
+    }
+
+    static Reg shuffle(Reg table, Reg index) {
+        return _mm512_shuffle_epi8(table, index);
+    }
+
+    // alignr works in 128-bit lanes, the lanes below are [prev.lane3, value.lane0..2]; masked as in broadcast16
+    static Reg shiftInByte(Reg value, Reg prev) {
+        return _mm512_alignr_epi8(value, _mm512_maskz_alignr_epi64(static_cast<__mmask8>(-1), value, prev, 6), 15);
+    }
+};
 
 #endif
+
+// Everything below is written once for all backends
+
+template <typename Ops>
+struct Nibbles {
+    typename Ops::Reg lo, hi;
+};
+
+template <typename Ops>
+[[gnu::always_inline]] inline Nibbles<Ops> nibbles(typename Ops::Reg value) {
+    auto const lowMask = Ops::set1(0x0f);
+    return {Ops::bitAnd(value, lowMask), Ops::bitAnd(Ops::template srli16<4>(value), lowMask)};
+}
+
+// every byte of src is an index into the 256-entry table
+template <typename Ops>
+[[gnu::always_inline]] inline typename Ops::Reg lookup(typename Ops::Reg src, std::array<uint8_t, TABLE_SIZE> const& table) {
+    auto const [lo, hi] = nibbles<Ops>(src);
+    auto result = Ops::set1(0);
+    for (auto i = 0u; i != TABLE_SIZE / 16; ++i) {
+        auto const part = Ops::shuffle(Ops::broadcast16(table.data() + i * 16), lo);
+        result = Ops::blend(result, part, Ops::cmpeq(hi, Ops::set1(static_cast<uint8_t>(i))));
+    }
+    return result;
+}
+
+// count of ones in every byte
+template <typename Ops>
+[[gnu::always_inline]] inline typename Ops::Reg popcount(typename Ops::Reg src) {
+    static constexpr std::array<uint8_t, 16> POPCOUNT4{0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+    auto const table = Ops::broadcast16(POPCOUNT4.data());
+    auto const [lo, hi] = nibbles<Ops>(src);
+    return Ops::add(Ops::shuffle(table, lo), Ops::shuffle(table, hi));
+}
+
+// count of bytes set in the mask
+template <typename Ops>
+[[gnu::always_inline]] inline size_t count(typename Ops::Mask mask) {
+    return static_cast<size_t>(std::popcount(Ops::movemask(mask)));
+}
+
+}
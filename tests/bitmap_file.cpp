@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "../bitmap_file.hpp"
+#include "bits.hpp"
+
+namespace {
+
+std::string tmpPath(std::string const& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+}
+
+TEST(MappedBitmap, Reload) {
+    std::mt19937 engine(42);
+    auto const path = tmpPath("gap_bitmap_reload.bin");
+    for (auto size : {1u, 7u, 64u, 1000u, 4096u * 3 + 5}) {
+        auto input = randomBits(size, 0.05, engine);
+        MappedBitmap::save(input, path, 256);
+
+        MappedBitmap bitmap(path);
+        ASSERT_EQ(bitmap.size(), size);
+        EXPECT_TRUE(bitmap.verify());
+        for (auto i = 0u; i != size; ++i) {
+            ASSERT_EQ(bitmap.get(i), input.get(i));
+        }
+
+        auto expected = summarize(input.rawData(), input.size());
+        auto summary = bitmap.summary();
+        EXPECT_EQ(summary.longest, expected.longest);
+        EXPECT_EQ(summary.longestPos, expected.longestPos);
+        EXPECT_EQ(summary.prefix, expected.prefix);
+        EXPECT_EQ(summary.suffix, expected.suffix);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(MappedBitmap, Distance) {
+    std::mt19937 engine(1337);
+    auto const path = tmpPath("gap_bitmap_distance.bin");
+    for (auto q : {0.5, 0.2, 0.01}) {
+        auto input = randomBits(5'000, q, engine);
+        MappedBitmap::save(input, path, 512);
+
+        {
+            MappedBitmap bitmap(path);
+            for (auto i = 0u; i != 300; ++i) {
+                distanceMemoized(input);
+                bitmap.distance();
+            }
+            bitmap.sync();
+        }
+
+        MappedBitmap bitmap(path);
+        EXPECT_TRUE(bitmap.verify());
+        for (auto i = 0u; i != input.size(); ++i) {
+            ASSERT_EQ(bitmap.get(i), input.get(i)) << i;
+        }
+        EXPECT_EQ(bitmap.summary().longest, summarize(input.rawData(), input.size()).longest);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(MappedBitmap, Reset) {
+    auto const path = tmpPath("gap_bitmap_reset.bin");
+    MappedBitmap::save(BoolVector(100), path, 64);
+
+    MappedBitmap bitmap(path);
+    EXPECT_EQ(bitmap.summary().longest, 100);
+    bitmap.set(10, true);
+    EXPECT_EQ(bitmap.summary().longest, 89);
+    EXPECT_EQ(bitmap.summary().longestPos, 11);
+    bitmap.set(10, false);
+    EXPECT_EQ(bitmap.summary().longest, 100);
+    EXPECT_TRUE(bitmap.verify());
+    std::filesystem::remove(path);
+}
+
+TEST(MappedBitmap, Corrupted) {
+    auto const path = tmpPath("gap_bitmap_corrupted.bin");
+    MappedBitmap::save(BoolVector(100), path);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(0);
+        file.put('X');
+    }
+    EXPECT_THROW(MappedBitmap{path}, std::runtime_error);
+
+    MappedBitmap::save(BoolVector(100), path);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(64);
+        file.put(1);
+    }
+    EXPECT_FALSE(MappedBitmap{path}.verify());
+
+    EXPECT_THROW(MappedBitmap{tmpPath("gap_bitmap_missing.bin")}, std::runtime_error);
+    EXPECT_THROW(MappedBitmap::save(BoolVector(100), path, 12), std::invalid_argument);
+    std::filesystem::remove(path);
+}
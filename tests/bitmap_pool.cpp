@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "../bitmap_pool.hpp"
+#include "../memoized.hpp"
+#include "bits.hpp"
+
+namespace {
+
+// index of the bitmap with the longest seq, the first one on ties
+std::optional<size_t> naiveBest(std::vector<BoolVector> const& bitmaps) {
+    std::optional<size_t> best;
+    size_t bestSize = 0;
+    for (auto i = 0u; i != bitmaps.size(); ++i) {
+        auto const longest = summarize(bitmaps[i].rawData(), bitmaps[i].size()).longest;
+        if (longest > bestSize) {
+            bestSize = longest;
+            best = i;
+        }
+    }
+    return best;
+}
+
+}
+
+TEST(BitmapPool, Tests) {
+    BitmapPool pool;
+    EXPECT_FALSE(pool.placeBest().has_value());
+
+    BoolVector full(10);
+    for (auto i = 0u; i != 10; ++i) {
+        full.set(i, true);
+    }
+    pool.add(full);
+    EXPECT_FALSE(pool.placeBest().has_value());
+
+    // more zeros, shorter seqs
+    BoolVector scattered(12);
+    for (auto i = 0u; i < 12; i += 3) {
+        scattered.set(i, true);
+    }
+    pool.add(scattered);
+    pool.add(BoolVector(5));
+
+    auto placement = pool.placeBest();
+    ASSERT_TRUE(placement.has_value());
+    EXPECT_EQ(placement->bitmap, 2);
+    EXPECT_EQ(placement->seqSize, 5);
+    EXPECT_EQ(placement->slot, 4);
+    EXPECT_TRUE(pool.bitmap(2).get(4));
+
+    // 4 vs 2: the seq of the third bitmap is still the longest
+    placement = pool.placeBest();
+    ASSERT_TRUE(placement.has_value());
+    EXPECT_EQ(placement->bitmap, 2);
+    EXPECT_EQ(placement->seqSize, 4);
+    EXPECT_EQ(placement->slot, 0);
+
+    // a freed bit joins the seqs of the first bitmap
+    pool.set(0, 3, false);
+    pool.set(0, 4, false);
+    pool.set(0, 5, false);
+    placement = pool.findBest();
+    ASSERT_TRUE(placement.has_value());
+    EXPECT_EQ(placement->bitmap, 0);
+    EXPECT_EQ(placement->seqSize, 3);
+    EXPECT_EQ(placement->slot, 4);
+    EXPECT_FALSE(pool.bitmap(0).get(4));
+}
+
+TEST(BitmapPool, Random) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<size_t> sizes(1, 300);
+    for (auto q : {0.5, 0.9, 0.98}) {
+        BitmapPool pool;
+        std::vector<BoolVector> expected;
+        for (auto i = 0u; i != 200; ++i) {
+            expected.push_back(randomBits(sizes(engine), q, engine));
+            pool.add(expected.back());
+        }
+
+        for (auto step = 0u; step != 2000; ++step) {
+            if (step % 7 == 0) {
+                std::uniform_int_distribution<size_t> index(0, expected.size() - 1);
+                auto const i = index(engine);
+                std::uniform_int_distribution<size_t> bit(0, expected[i].size() - 1);
+                auto const j = bit(engine);
+                expected[i].set(j, false);
+                pool.set(i, j, false);
+                continue;
+            }
+
+            auto const best = naiveBest(expected);
+            auto const placement = pool.placeBest();
+            ASSERT_EQ(placement.has_value(), best.has_value());
+            if (!best) {
+                continue;
+            }
+            ASSERT_EQ(placement->bitmap, *best) << "step: " << step;
+            distanceMemoized(expected[*best]);
+            for (auto j = 0u; j != expected[*best].size(); ++j) {
+                ASSERT_EQ(pool.bitmap(*best).get(j), expected[*best].get(j)) << "step: " << step;
+            }
+        }
+        EXPECT_LT(pool.scans(), 200 + 2000 * 10);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../distance.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+
+// BoolVector from a string of '0' and '1'
+inline BoolVector fromString(std::string const& v) {
+    BoolVector vec(v.size());
+    for (auto i = 0u; i != v.size(); ++i) {
+        vec.set(i, v[i] - '0');
+    }
+    return vec;
+}
+
+inline std::string toString(BoolVector const& vec) {
+    std::string out(vec.size(), '0');
+    for (auto i = 0u; i != vec.size(); ++i) {
+        out[i] = static_cast<char>(vec.get(i)) + '0';
+    }
+    return out;
+}
+
+// every bit is one with probability q
+inline BoolVector randomBits(size_t size, double q, std::mt19937& engine) {
+    std::bernoulli_distribution bernoulli(q);
+    BoolVector out(size);
+    for (auto i = 0u; i != size; ++i) {
+        out.set(i, bernoulli(engine));
+    }
+    return out;
+}
+
+// the same bits for the slow implementations
+inline std::vector<bool> toVectorBool(BoolVector const& vec) {
+    std::vector<bool> out(vec.size());
+    for (auto i = 0u; i != vec.size(); ++i) {
+        out[i] = vec.get(i);
+    }
+    return out;
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <thread>
+
+#include "../concurrent.hpp"
+#include "bits.hpp"
+
+TEST(ConcurrentBoolVector, SameAsMemoized) {
+    std::mt19937 engine(42);
+    for (auto size : {1u, 63u, 64u, 65u, 1000u, 64u * 64 * 3 + 17}) {
+        for (auto q : {0.5, 0.2, 0.05}) {
+            auto input = randomBits(size, q, engine);
+            ConcurrentBoolVector concurrent(input);
+            for (auto i = 0u; i != std::min(size, 200u); ++i) {
+                auto before = summarize(input.rawData(), input.size());
+                distanceMemoized(input);
+                auto slot = concurrent.claimBestGap();
+                if (before.longest == 0) {
+                    EXPECT_FALSE(slot.has_value());
+                    break;
+                }
+                ASSERT_TRUE(slot.has_value());
+                ASSERT_TRUE(input.get(*slot));
+            }
+            for (auto i = 0u; i != size; ++i) {
+                ASSERT_EQ(concurrent.get(i), input.get(i)) << i;
+            }
+        }
+    }
+}
+
+TEST(ConcurrentBoolVector, ClaimRelease) {
+    ConcurrentBoolVector bits(100);
+    EXPECT_EQ(bits.claimBestGap(), 99);
+    EXPECT_EQ(bits.claimBestGap(), 0);
+    EXPECT_EQ(bits.claimBestGap(), 50);
+    bits.release(50);
+    EXPECT_FALSE(bits.get(50));
+    EXPECT_EQ(bits.claimBestGap(), 50);
+}
+
+TEST(ConcurrentBoolVector, Threads) {
+    static constexpr size_t SIZE = 64 * 64 * 2 + 5;
+    static constexpr size_t THREADS = 8;
+
+    ConcurrentBoolVector bits(SIZE);
+    std::vector<std::vector<size_t>> claimed(THREADS);
+    std::vector<std::thread> threads;
+    for (auto t = 0u; t != THREADS; ++t) {
+        threads.emplace_back([&bits, &out = claimed[t]] {
+            while (auto slot = bits.claimBestGap()) {
+                out.push_back(*slot);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<bool> seen(SIZE, false);
+    size_t total = 0;
+    for (auto const& slots : claimed) {
+        for (auto slot : slots) {
+            ASSERT_FALSE(seen[slot]) << slot;
+            seen[slot] = true;
+            ++total;
+        }
+    }
+    EXPECT_EQ(total, SIZE);
+    for (auto i = 0u; i != SIZE; ++i) {
+        ASSERT_TRUE(bits.get(i));
+    }
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "../find_run.hpp"
+#include "bits.hpp"
+
+TEST(FindRun, Tests) {
+    auto input = fromString("1001000100001");
+    EXPECT_EQ(findRun(input, 2, FitPolicy::First), 1);
+    EXPECT_EQ(findRun(input, 3, FitPolicy::First), 4);
+    EXPECT_EQ(findRun(input, 3, FitPolicy::Best), 4);
+    EXPECT_EQ(findRun(input, 4, FitPolicy::First), 8);
+    EXPECT_EQ(findRun(input, 5, FitPolicy::First), std::nullopt);
+
+    EXPECT_EQ(findRun(fromString("0000010001"), 3, FitPolicy::First), 0);
+    EXPECT_EQ(findRun(fromString("0000010001"), 3, FitPolicy::Best), 6);
+    EXPECT_EQ(findRun(fromString("1000000000"), 9, FitPolicy::Best), 1);
+    EXPECT_EQ(findRun(fromString("1111111111"), 1, FitPolicy::First), std::nullopt);
+    EXPECT_EQ(findRun(fromString("0"), 1, FitPolicy::Best), 0);
+}
+
+TEST(FindRun, Random) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<size_t> uniform(1, 3000);
+    for (auto q : {0.5, 0.2, 0.05, 0.005}) {
+        for (auto i = 0u; i != 300; ++i) {
+            auto const size = uniform(engine);
+            auto const input = randomBits(size, q, engine);
+            auto const slow = toVectorBool(input);
+
+            for (auto length : {1u, 2u, 5u, 7u, 9u, 20u, 63u, 64u, 65u, 200u}) {
+                for (auto policy : {FitPolicy::First, FitPolicy::Best}) {
+                    ASSERT_EQ(findRun(input, length, policy), findRunSlow(slow, length, policy))
+                        << "size: " << size << " length: " << length << " best: " << (policy == FitPolicy::Best);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "../histogram.hpp"
+#include "bits.hpp"
+
+TEST(GapHistogram, Tests) {
+    auto input = fromString("0010110001000000000000000000100");
+
+    auto histogram = gapHistogram(input);
+    EXPECT_EQ(histogram.seqs, 5);
+    EXPECT_EQ(histogram.zeros, 2 + 1 + 3 + 18 + 2);
+    EXPECT_EQ(histogram.exact[1], 1);
+    EXPECT_EQ(histogram.exact[2], 2);
+    EXPECT_EQ(histogram.exact[3], 1);
+    EXPECT_EQ(histogram.log2[0], 1);
+    EXPECT_EQ(histogram.log2[1], 3);
+    EXPECT_EQ(histogram.log2[4], 1);
+
+    EXPECT_EQ(gapHistogram(BoolVector(1000)).log2[9], 1);
+}
+
+TEST(GapHistogram, Random) {
+    std::mt19937 engine(42);
+    std::uniform_int_distribution<size_t> uniform(1, 20'000);
+    for (auto q : {0.5, 0.2, 0.05, 0.001}) {
+        for (auto i = 0u; i != 50; ++i) {
+            auto const size = uniform(engine);
+            auto const input = randomBits(size, q, engine);
+            auto const slow = toVectorBool(input);
+
+            auto const expected = gapHistogramSlow(slow);
+            ASSERT_EQ(gapHistogram(input), expected) << "size: " << size;
+            for (auto threads : {1u, 2u, 3u, 8u}) {
+                ASSERT_EQ(gapHistogram(input, threads), expected) << "size: " << size << " threads: " << threads;
+            }
+        }
+    }
+}
@@ -2,6 +2,8 @@
 
 #include "../simd.hpp"
 
+#include <random>
+
 constexpr std::array<uint8_t, 256> createArray() {
     std::array<uint8_t, 256> arr{};
     for (size_t i = 0; i < arr.size(); ++i) {
@@ -13,35 +15,116 @@ constexpr std::array<uint8_t, 256> createArray() {
 [[maybe_unused]]
 constexpr std::array<uint8_t, 256> lookupTable = createArray();
 
-#ifdef AVX512F
+template <typename Ops>
+class SimdTest : public ::testing::Test {
+public:
+    static constexpr auto WIDTH = Ops::WIDTH;
+    using Bytes = std::array<uint8_t, WIDTH>;
 
-TEST(SIMD512F_lookup, Base) {
+    static Bytes randomBytes(unsigned seed) {
+        std::mt19937 engine(seed);
+        std::uniform_int_distribution<unsigned> uniform(0, 255);
+        Bytes out{};
+        for (auto& v : out) {
+            v = static_cast<uint8_t>(uniform(engine));
+        }
+        return out;
+    }
 
-    std::array<uint8_t, 64> arr{};
-    for (size_t i = 0; i < arr.size(); ++i) {
-        arr[i] = i;
+    static Bytes store(typename Ops::Reg value) {
+        Bytes out{};
+        Ops::store(out.data(), value);
+        return out;
     }
-    auto result = shuffle(_mm512_load_epi64(arr.data()), lookupTable);
-    _mm512_store_epi64(arr.data(), result);
+};
+
+TYPED_TEST_SUITE_P(SimdTest);
+
+TYPED_TEST_P(SimdTest, LoadStore) {
+    auto const src = this->randomBytes(1);
+    EXPECT_EQ(this->store(TypeParam::load(src.data())), src);
+}
+
+TYPED_TEST_P(SimdTest, Compare) {
+    auto const a = this->randomBytes(2);
+    auto b = this->randomBytes(3);
+    b[0] = a[0];
+    b[this->WIDTH - 1] = a[this->WIDTH - 1];
 
-    for (auto i = 0u; i != arr.size(); ++i) {
-        EXPECT_EQ(arr[i], 64 - i);
+    auto const ra = TypeParam::load(a.data());
+    auto const rb = TypeParam::load(b.data());
+    auto const eq = TypeParam::movemask(TypeParam::cmpeq(ra, rb));
+    auto const le = TypeParam::movemask(TypeParam::cmple(ra, rb));
+    for (auto i = 0u; i != this->WIDTH; ++i) {
+        EXPECT_EQ((eq >> i) & 1, a[i] == b[i]) << i;
+        EXPECT_EQ((le >> i) & 1, a[i] <= b[i]) << i;
     }
+    EXPECT_EQ(simd::count<TypeParam>(TypeParam::cmple(ra, rb)), static_cast<size_t>(std::popcount(le)));
 }
 
-TEST(SIMD256_lookup, Base) {
+TYPED_TEST_P(SimdTest, Blend) {
+    auto const a = this->randomBytes(4);
+    auto const b = this->randomBytes(5);
+    auto const ra = TypeParam::load(a.data());
+    auto const rb = TypeParam::load(b.data());
+    auto const result = this->store(TypeParam::blend(ra, rb, TypeParam::cmple(ra, rb)));
+    for (auto i = 0u; i != this->WIDTH; ++i) {
+        EXPECT_EQ(result[i], std::max(a[i], b[i])) << i;
+    }
+}
 
-    std::array<uint8_t, 64> arr{};
-    for (size_t i = 0; i < arr.size(); ++i) {
-        arr[i] = i;
+TYPED_TEST_P(SimdTest, Shuffle) {
+    auto const src = this->randomBytes(6);
+    auto const table = TypeParam::broadcast16(lookupTable.data());
+    auto const [lo, hi] = simd::nibbles<TypeParam>(TypeParam::load(src.data()));
+    auto const result = this->store(TypeParam::shuffle(table, hi));
+    for (auto i = 0u; i != this->WIDTH; ++i) {
+        EXPECT_EQ(result[i], lookupTable[src[i] >> 4]) << i;
     }
-    auto result = shuffle(_mm256_loadu_epi64(arr.data()), lookupTable);
-    _mm256_store_epi64(arr.data(), result);
+    EXPECT_EQ(this->store(lo)[0], src[0] & 0x0f);
+}
 
-    for (auto i = 0u; i != arr.size(); ++i) {
-        EXPECT_EQ(arr[i], 64 - i);
+TYPED_TEST_P(SimdTest, Lookup) {
+    for (auto base = 0u; base < 256; base += this->WIDTH) {
+        typename TestFixture::Bytes src{};
+        for (auto i = 0u; i != this->WIDTH; ++i) {
+            src[i] = static_cast<uint8_t>(base + i);
+        }
+        auto const result = this->store(simd::lookup<TypeParam>(TypeParam::load(src.data()), lookupTable));
+        for (auto i = 0u; i != this->WIDTH; ++i) {
+            EXPECT_EQ(result[i], 255 - src[i]);
+        }
     }
 }
 
+TYPED_TEST_P(SimdTest, Popcount) {
+    auto const src = this->randomBytes(7);
+    auto const result = this->store(simd::popcount<TypeParam>(TypeParam::load(src.data())));
+    for (auto i = 0u; i != this->WIDTH; ++i) {
+        EXPECT_EQ(result[i], std::popcount(src[i])) << i;
+    }
+}
+
+TYPED_TEST_P(SimdTest, ShiftInByte) {
+    auto const value = this->randomBytes(8);
+    auto const prev = this->randomBytes(9);
+    auto const result = this->store(TypeParam::shiftInByte(TypeParam::load(value.data()), TypeParam::load(prev.data())));
+    EXPECT_EQ(result[0], prev[this->WIDTH - 1]);
+    for (auto i = 1u; i != this->WIDTH; ++i) {
+        EXPECT_EQ(result[i], value[i - 1]) << i;
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(SimdTest, LoadStore, Compare, Blend, Shuffle, Lookup, Popcount, ShiftInByte);
+
+#ifdef __SSE4_2__
+INSTANTIATE_TYPED_TEST_SUITE_P(SSE42, SimdTest, simd::SSE42);
+#endif
+
+#ifdef __AVX2__
+INSTANTIATE_TYPED_TEST_SUITE_P(AVX2, SimdTest, simd::AVX2);
 #endif
 
+#ifdef AVX512F
+INSTANTIATE_TYPED_TEST_SUITE_P(AVX512, SimdTest, simd::AVX512);
+#endif
@@ -4,6 +4,8 @@
 #include <random>
 
 #include "../distance.hpp"
+#include "../chunk_width.hpp"
+#include "bits.hpp"
 
 using sv = std::string_view;
 
@@ -40,24 +42,45 @@ struct WrapperVector {
 template <void(*fn)(BoolVector&)>
 struct WrapperCustomBool {
     auto operator()(std::string& v) const {
-        BoolVector vec(v.size());
-        for (auto i = 0u; i != v.size(); ++i) {
-            vec.set(i, v[i] - '0');
-        }
+        auto vec = fromString(v);
         fn(vec);
         assert(vec.size() == v.size());
-        for (auto i = 0u; i != vec.size(); ++i) {
-            v[i] = static_cast<char>(vec.get(i)) + '0';
-        }
+        v = toString(vec);
     }
 };
 
 using SlowT = WrapperVectorBool<distanceSlow>;
+using VectorBoolT = WrapperVectorBool<distanceVectorBool>;
 using SlowUintT = WrapperVector<distanceUintSlow>;
 using SlowUintBranchLessT = WrapperVector<distanceUintSlowBranchLess>;
 using MemoizedT = WrapperCustomBool<distanceMemoized>;
 using MemoizedAlignedT = WrapperCustomBool<distanceMemoizedAligned>;
 using MemoizedBranchLessT = WrapperCustomBool<distanceMemoizedBranchLess>;
+using MemoizedPackedStateT = WrapperCustomBool<distanceMemoizedPackedState>;
+using MemoizedPackedT = WrapperCustomBool<distanceMemoizedLayout<PackedLayout>>;
+using MemoizedSoAT = WrapperCustomBool<distanceMemoizedLayout<SoALayout>>;
+using MemoizedBitPackedT = WrapperCustomBool<distanceMemoizedLayout<BitPackedLayout>>;
+using MemoizedBranchLessPackedT = WrapperCustomBool<distanceMemoizedBranchLessLayout<PackedLayout>>;
+using MemoizedBranchLessSoAT = WrapperCustomBool<distanceMemoizedBranchLessLayout<SoALayout>>;
+using MemoizedBranchLessBitPackedT = WrapperCustomBool<distanceMemoizedBranchLessLayout<BitPackedLayout>>;
+using MemoizedWidth8T = WrapperCustomBool<distanceMemoizedWidth<8>>;
+using MemoizedWidth11T = WrapperCustomBool<distanceMemoizedWidth<11>>;
+using MemoizedWidth12T = WrapperCustomBool<distanceMemoizedWidth<12>>;
+using MemoizedWidth16T = WrapperCustomBool<distanceMemoizedWidth<16>>;
+#ifdef __AVX2__
+using MemoizedWidthGather8T = WrapperCustomBool<distanceMemoizedWidthGather<8>>;
+using MemoizedWidthGather13T = WrapperCustomBool<distanceMemoizedWidthGather<13>>;
+using MemoizedWidthGather16T = WrapperCustomBool<distanceMemoizedWidthGather<16>>;
+#endif
+#ifdef __SSE4_2__
+using MemoizedSSET = WrapperCustomBool<distanceMemoizedSSE>;
+#endif
+#ifdef __AVX2__
+using MemoizedAVX2T = WrapperCustomBool<distanceMemoizedAVX2>;
+#endif
+#ifdef AVX512F
+using MemoizedAVXT = WrapperCustomBool<distanceMemoizedAVX>;
+#endif
 
 template <typename Fn>
 class DistanceTest : public ::testing::Test {
@@ -151,13 +174,47 @@ TYPED_TEST_P(DistanceTest, Random) {
     }
 }
 
-REGISTER_TYPED_TEST_SUITE_P(DistanceTest, Tests, Big, Random);
+// zero bytes and long seqs over several of them
+TYPED_TEST_P(DistanceTest, Sparse) {
+    static constexpr size_t TEST_CASES = 1'000;
+    for (auto q : {0.05, 0.01}) {
+        for (auto i = 0; i != TEST_CASES; ++i) {
+            this->test(random(1, 5000, q));
+        }
+    }
+}
+
+REGISTER_TYPED_TEST_SUITE_P(DistanceTest, Tests, Big, Random, Sparse);
 
 INSTANTIATE_TYPED_TEST_SUITE_P(Slow, DistanceTest, SlowT);
+INSTANTIATE_TYPED_TEST_SUITE_P(VectorBool, DistanceTest, VectorBoolT);
 INSTANTIATE_TYPED_TEST_SUITE_P(SlowUint, DistanceTest, SlowUintT);
 INSTANTIATE_TYPED_TEST_SUITE_P(SlowUintBranchLess, DistanceTest, SlowUintBranchLessT);
 INSTANTIATE_TYPED_TEST_SUITE_P(Memoized, DistanceTest, MemoizedT);
 INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedAlign, DistanceTest, MemoizedAlignedT);
 INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedBranchLess, DistanceTest, MemoizedBranchLessT);
-
-
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedPackedState, DistanceTest, MemoizedPackedStateT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedPacked, DistanceTest, MemoizedPackedT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedSoA, DistanceTest, MemoizedSoAT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedBitPacked, DistanceTest, MemoizedBitPackedT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedBranchLessPacked, DistanceTest, MemoizedBranchLessPackedT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedBranchLessSoA, DistanceTest, MemoizedBranchLessSoAT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedBranchLessBitPacked, DistanceTest, MemoizedBranchLessBitPackedT);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidth8, DistanceTest, MemoizedWidth8T);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidth11, DistanceTest, MemoizedWidth11T);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidth12, DistanceTest, MemoizedWidth12T);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidth16, DistanceTest, MemoizedWidth16T);
+#ifdef __AVX2__
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidthGather8, DistanceTest, MemoizedWidthGather8T);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidthGather13, DistanceTest, MemoizedWidthGather13T);
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedWidthGather16, DistanceTest, MemoizedWidthGather16T);
+#endif
+#ifdef __SSE4_2__
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedSSE, DistanceTest, MemoizedSSET);
+#endif
+#ifdef __AVX2__
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedAVX2, DistanceTest, MemoizedAVX2T);
+#endif
+#ifdef AVX512F
+INSTANTIATE_TYPED_TEST_SUITE_P(MemoizedAVX, DistanceTest, MemoizedAVXT);
+#endif
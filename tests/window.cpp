@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <random>
+
+#include "../window.hpp"
+
+namespace {
+
+SlidingGapWindow::Gap longestSlow(std::deque<bool> const& window, bool circular) {
+    size_t longestSeqSize = 0;
+    size_t longestSeqPos = 0;
+    size_t current = 0;
+    size_t prefix = window.size();
+    for (auto i = 0u; i != window.size(); ++i) {
+        if (window[i]) {
+            prefix = std::min<size_t>(prefix, i);
+            current = 0;
+        } else if (++current > longestSeqSize) {
+            longestSeqSize = current;
+            longestSeqPos = i + 1 - current;
+        }
+    }
+
+    if (circular && prefix != window.size() && current + prefix > longestSeqSize) {
+        longestSeqSize = current + prefix;
+        longestSeqPos = window.size() - current;
+    }
+    return {longestSeqPos, longestSeqSize, (longestSeqPos + longestSeqSize / 2) % window.size()};
+}
+
+void check(SlidingGapWindow const& window, std::deque<bool> const& expected) {
+    ASSERT_EQ(window.size(), expected.size());
+    auto gap = window.longest();
+    auto ans = longestSlow(expected, window.circular());
+    EXPECT_EQ(gap.size, ans.size);
+    EXPECT_EQ(gap.pos, ans.pos);
+    EXPECT_EQ(gap.midpoint, ans.midpoint);
+}
+
+}
+
+TEST(SlidingGapWindow, Base) {
+    SlidingGapWindow window(16);
+    EXPECT_EQ(window.longest().size, 0);
+
+    window.pushByte(0b1000'0001);
+    EXPECT_EQ(window.longest().size, 6);
+    EXPECT_EQ(window.longest().pos, 1);
+    EXPECT_EQ(window.longest().midpoint, 4);
+
+    window.pushByte(0b0000'0001);
+    EXPECT_EQ(window.longest().size, 7);
+    EXPECT_EQ(window.longest().pos, 9);
+
+    window.pushByte(0b1111'1111);
+    EXPECT_EQ(window.longest().size, 7);
+    EXPECT_EQ(window.longest().pos, 1);
+
+    window.push(false);
+    EXPECT_EQ(window.longest().size, 7);
+    EXPECT_EQ(window.longest().pos, 0);
+    EXPECT_EQ(window.longest().midpoint, 3);
+}
+
+TEST(SlidingGapWindow, Circular) {
+    SlidingGapWindow window(16, true);
+    window.pushByte(0b0001'1000);
+    window.pushByte(0b0000'0100);
+    auto gap = window.longest();
+    EXPECT_EQ(gap.size, 5 + 3);
+    EXPECT_EQ(gap.pos, 11);
+    EXPECT_EQ(gap.midpoint, 15);
+
+    window.pushByte(0);
+    window.pushByte(0);
+    EXPECT_EQ(window.longest().size, 16);
+}
+
+TEST(SlidingGapWindow, InvalidSize) {
+    EXPECT_THROW(SlidingGapWindow(0), std::invalid_argument);
+    EXPECT_THROW(SlidingGapWindow(12), std::invalid_argument);
+}
+
+TEST(SlidingGapWindow, Random) {
+    std::mt19937 engine(42);
+    for (auto windowBits : {8u, 16u, 64u, 200u}) {
+        for (auto circular : {false, true}) {
+            for (auto q : {0.5, 0.2, 0.05}) {
+                std::bernoulli_distribution bernoulli(q);
+                std::bernoulli_distribution useByte(0.3);
+                SlidingGapWindow window(windowBits, circular);
+                std::deque<bool> expected;
+                for (auto i = 0u; i != 2'000; ++i) {
+                    if (useByte(engine)) {
+                        uint8_t value = 0;
+                        for (auto j = 0u; j != 8; ++j) {
+                            bool bit = bernoulli(engine);
+                            value |= bit << j;
+                            expected.push_back(bit);
+                        }
+                        window.pushByte(value);
+                    } else {
+                        bool bit = bernoulli(engine);
+                        expected.push_back(bit);
+                        window.push(bit);
+                    }
+                    while (expected.size() > windowBits) {
+                        expected.pop_front();
+                    }
+                    check(window, expected);
+                }
+            }
+        }
+    }
+}
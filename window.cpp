@@ -0,0 +1,100 @@
+#include "window.hpp"
+
+
+SlidingGapWindow::SlidingGapWindow(size_t windowBits, bool circular)
+    : m_window(windowBits)
+    , m_circular(circular)
+    , m_ring(windowBits / 8 + 1, 0) {
+    if (windowBits == 0 || windowBits % 8 != 0) {
+        throw std::invalid_argument("Window size must be a positive multiple of 8");
+    }
+    m_front.reserve(windowBits / 8);
+}
+
+void SlidingGapWindow::pushFull(GapSummary const& summary) {
+    ++m_backCount;
+    m_backMerged = merge(m_backMerged, summary);
+}
+
+void SlidingGapWindow::popFull() {
+    if (m_front.empty()) {
+        // the back bytes are still in the ring: only the expired ones are overwritten
+        for (auto i = m_backCount; i != 0; --i) {
+            auto const pos = m_backMerged.begin + (i - 1) * 8;
+            auto const summary = summarize8(ringByte(pos), pos);
+            m_front.push_back(m_front.empty() ? summary : merge(summary, m_front.back()));
+        }
+        m_backMerged = {};
+        m_backCount = 0;
+    }
+    assert(!m_front.empty());
+    m_front.pop_back();
+}
+
+void SlidingGapWindow::push(bool value) {
+    auto const bit = m_total % 8;
+    auto& byte = ringByte(m_total);
+    if (bit == 0) {
+        byte = 0;
+    }
+    byte |= value << bit;
+    ++m_total;
+
+    if (bit == 7) {
+        // the pending byte is full now, the partially expired one is gone
+        pushFull(summarize8(byte, m_total - 8));
+    } else if (bit == 0 && m_total > m_window) {
+        // the oldest full byte starts to expire
+        popFull();
+    }
+}
+
+void SlidingGapWindow::pushByte(uint8_t value) {
+    if (m_total % 8 != 0) [[unlikely]] {
+        for (auto i = 0u; i != 8; ++i) {
+            push(value & (1 << i));
+        }
+        return;
+    }
+
+    ringByte(m_total) = value;
+    m_total += 8;
+    pushFull(summarize8(value, m_total - 8));
+    if (m_total > m_window) {
+        popFull();
+    }
+}
+
+SlidingGapWindow::Gap SlidingGapWindow::longest() const {
+    auto const bit = m_total % 8;
+    auto const start = m_total - size();
+
+    GapSummary summary{};
+    if (bit != 0 && m_total > m_window) {
+        summary = summarize8(ringByte(start) >> bit, start, 8 - bit);
+    }
+    if (!m_front.empty()) {
+        summary = merge(summary, m_front.back());
+    }
+    summary = merge(summary, m_backMerged);
+    if (bit != 0) {
+        summary = merge(summary, summarize8(ringByte(m_total), m_total - bit, bit));
+    }
+
+    if (summary.empty()) [[unlikely]] {
+        return {0, 0, 0};
+    }
+
+    auto pos = summary.longestPos;
+    if (summary.inChunk) {
+        pos += innerSeqPos(ringByte(pos) >> (pos % 8));
+    }
+
+    Gap gap{pos - start, summary.longest, 0};
+    if (m_circular && !summary.zeros() && summary.suffix + summary.prefix > gap.size) {
+        gap.pos = summary.size - summary.suffix;
+        gap.size = summary.suffix + summary.prefix;
+    }
+    gap.midpoint = (gap.pos + gap.size / 2) % summary.size;
+    return gap;
+}
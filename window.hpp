@@ -0,0 +1,66 @@
+#pragma once
+
+#include "memoized.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+
+// Longest seq of `0` over the last `windowBits` bits of an unbounded stream.
+// Bytes are kept in a ring and summarized in a two-stack queue of GapSummary, only the front stack is stored:
+// append is amortized O(1) per byte and the query merges at most four summaries.
+class SlidingGapWindow {
+public:
+    struct Gap {
+        size_t pos; // from the oldest bit of the window, wraps around in the circular mode
+        size_t size;
+        size_t midpoint;
+    };
+
+    explicit SlidingGapWindow(size_t windowBits, bool circular = false);
+
+    void push(bool value);
+
+    // bit order is the same as in BoolVector: the lowest bit comes first
+    void pushByte(uint8_t value);
+
+    Gap longest() const;
+
+    size_t size() const {
+        return m_total < m_window ? m_total : m_window;
+    }
+
+    size_t capacity() const {
+        return m_window;
+    }
+
+    bool circular() const {
+        return m_circular;
+    }
+
+private:
+    size_t m_window;
+    bool m_circular;
+    size_t m_total = 0;
+
+    // last `windowBits / 8 + 1` bytes: the partially expired one, full ones and the pending one
+    std::vector<uint8_t> m_ring;
+
+    // full bytes of the window
+    std::vector<GapSummary> m_front; // suffix merges, the oldest byte on top
+    // the newer bytes are only merged, popFull summarizes them again from m_ring
+    GapSummary m_backMerged{};
+    size_t m_backCount = 0;
+
+    uint8_t& ringByte(size_t pos) {
+        return m_ring[(pos / 8) % m_ring.size()];
+    }
+
+    uint8_t ringByte(size_t pos) const {
+        return m_ring[(pos / 8) % m_ring.size()];
+    }
+
+    void pushFull(GapSummary const& summary);
+    void popFull();
+};